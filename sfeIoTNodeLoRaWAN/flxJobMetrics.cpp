@@ -0,0 +1,81 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxJobMetrics.h"
+
+#include <cstring>
+
+flxJobMetrics *flxJobMetrics::_head = nullptr;
+
+//----------------------------------------------------------------
+flxJobMetrics::flxJobMetrics(const char *name) : _name{name}, _next{nullptr}
+{
+    reset();
+
+    // add to the end of the list - so output is in declaration order
+    flxJobMetrics **pLink = &_head;
+    while (*pLink != nullptr)
+        pLink = &(*pLink)->_next;
+    *pLink = this;
+}
+//----------------------------------------------------------------
+void flxJobMetrics::record(uint32_t elapsedUS)
+{
+    _nRuns++;
+    _totalUS += elapsedUS;
+    if (elapsedUS > _maxUS)
+        _maxUS = elapsedUS;
+}
+//----------------------------------------------------------------
+void flxJobMetrics::recordSchedule(uint32_t startMS, uint32_t endMS, uint32_t periodMS)
+{
+    if (_hasSchedule)
+    {
+        // early is on time
+        int32_t late = (int32_t)(startMS - _dueMS);
+        uint32_t lateMS = late > 0 ? late : 0;
+
+        // Way past due? The job was out of the queue - start over
+        if (lateMS <= kLateMaxPeriods * _periodMS)
+        {
+            uint8_t bin = 0;
+            for (uint32_t limit = 10; bin < kLateBins - 1 && lateMS >= limit; limit *= 10)
+                bin++;
+
+            _lateHist[bin]++;
+            _nLateSamples++;
+
+            if (lateMS > _maxLateMS)
+                _maxLateMS = lateMS;
+            if (lateMS > _periodMS)
+                _nOverruns++;
+        }
+    }
+    // The job queue schedules the next run from the end of this one
+    _hasSchedule = true;
+    _dueMS = endMS + periodMS;
+    _periodMS = periodMS;
+}
+//----------------------------------------------------------------
+void flxJobMetrics::reset(void)
+{
+    _nRuns = 0;
+    _totalUS = 0;
+    _maxUS = 0;
+
+    _hasSchedule = false;
+    _dueMS = 0;
+    _periodMS = 0;
+
+    memset(_lateHist, 0, sizeof(_lateHist));
+    _nLateSamples = 0;
+    _maxLateMS = 0;
+    _nOverruns = 0;
+}
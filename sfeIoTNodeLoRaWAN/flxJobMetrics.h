@@ -0,0 +1,135 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Run time accounting for jobs - the number of runs (wakeups), with the total and longest run time of
+// each. Used to find what keeps the board awake, and for the power use estimate.
+//
+// For a periodic job, the lateness of each run is also recorded - the time past when the job was due,
+// from the end of its last run and its period. A run that is more than a period late is an overrun. A
+// run more than kLateMaxPeriods late is taken as the job having been out of the queue, and not counted.
+//
+// Metrics objects are declared statically next to the job they measure, and add themselves to a list
+// that is walked for output.
+
+#include <Arduino.h>
+#include <Flux/flxCoreJobs.h>
+
+class flxJobMetrics
+{
+  public:
+    // Lateness histogram - bins by decade of ms: <10, <100, <1000, <10000, and 10000 or more
+    static constexpr uint8_t kLateBins = 5;
+    static constexpr uint32_t kLateMaxPeriods = 4;
+
+    flxJobMetrics(const char *name);
+
+    // Record one run of the job - its run time in microseconds
+    void record(uint32_t elapsedUS);
+
+    // Record the timing of a periodic job run - start and end in ms, and the job period in ms
+    void recordSchedule(uint32_t startMS, uint32_t endMS, uint32_t periodMS);
+
+    void reset(void);
+
+    const char *name(void) const
+    {
+        return _name;
+    }
+    uint32_t nRuns(void) const
+    {
+        return _nRuns;
+    }
+    uint64_t totalTime(void) const
+    {
+        return _totalUS;
+    }
+    uint32_t maxTime(void) const
+    {
+        return _maxUS;
+    }
+
+    // Lateness - runs in a histogram bin, the most late (ms) and the number of overruns
+    uint32_t lateHistogram(uint8_t bin) const
+    {
+        return bin < kLateBins ? _lateHist[bin] : 0;
+    }
+    uint32_t nLateSamples(void) const
+    {
+        return _nLateSamples;
+    }
+    uint32_t maxLate(void) const
+    {
+        return _maxLateMS;
+    }
+    uint32_t nOverruns(void) const
+    {
+        return _nOverruns;
+    }
+
+    // The list of metrics objects
+    static flxJobMetrics *first(void)
+    {
+        return _head;
+    }
+    flxJobMetrics *next(void) const
+    {
+        return _next;
+    }
+
+  private:
+    const char *_name;
+
+    uint32_t _nRuns;
+    uint64_t _totalUS;
+    uint32_t _maxUS;
+
+    // periodic job timing - when the next run is due (ms), and its period
+    bool _hasSchedule;
+    uint32_t _dueMS;
+    uint32_t _periodMS;
+
+    uint32_t _lateHist[kLateBins];
+    uint32_t _nLateSamples;
+    uint32_t _maxLateMS;
+    uint32_t _nOverruns;
+
+    flxJobMetrics *_next;
+    static flxJobMetrics *_head;
+};
+
+// Times a block - the elapsed time is recorded when it goes out of scope. If the block is a job callback,
+// pass the job to also record its lateness.
+class flxJobMetricsScope
+{
+  public:
+    flxJobMetricsScope(flxJobMetrics &metrics, flxJob *pJob = nullptr)
+        : _metrics{metrics}, _pJob{pJob}, _startMS{millis()}, _startUS{micros()}
+    {
+    }
+    flxJobMetricsScope(flxJobMetrics &metrics, flxJob &theJob) : flxJobMetricsScope(metrics, &theJob)
+    {
+    }
+    ~flxJobMetricsScope()
+    {
+        _metrics.record(micros() - _startUS);
+
+        // the period is read after the run - the job may have changed it
+        if (_pJob != nullptr)
+            _metrics.recordSchedule(_startMS, millis(), _pJob->period());
+    }
+
+  private:
+    flxJobMetrics &_metrics;
+    flxJob *_pJob;
+    uint32_t _startMS;
+    uint32_t _startUS;
+};
@@ -0,0 +1,240 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxLoRaWANClockSync.h"
+#include <Flux/flxCoreEvent.h>
+
+// Package identifier and version - answer to a PackageVersionReq
+const uint8_t kClockSyncPackageID = 1;
+const uint8_t kClockSyncPackageVersion = 1;
+
+// AppTimeReq param - the token (bits 0-3), and the answer required flag
+const uint8_t kClockSyncTokenMask = 0x0F;
+const uint8_t kClockSyncAnsRequired = 0x10;
+
+// GPS epoch (used by LoRaWAN) to unix epoch - seconds between the epochs, less the leap seconds since
+const uint32_t kGPSEpochOffset = 315964800;
+const uint32_t kGPSLeapSeconds = 18;
+
+// Time to wait before retrying a sync that wasn't answered - and after a join (ms)
+const uint32_t kClockSyncRetryTime = 600000;
+const uint32_t kClockSyncJoinDelay = 15000;
+
+const uint32_t kClockSyncDefaultInterval = 24;
+
+//----------------------------------------------------------------
+// little endian - the byte order of the LoRaWAN application packages
+static void packUInt32LE(uint32_t value, uint8_t *buffer)
+{
+    for (int i = 0; i < 4; i++, value >>= 8)
+        buffer[i] = value & 0xFF;
+}
+
+static uint32_t unpackUInt32LE(const uint8_t *buffer)
+{
+    return (uint32_t)buffer[0] | ((uint32_t)buffer[1] << 8) | ((uint32_t)buffer[2] << 16) |
+           ((uint32_t)buffer[3] << 24);
+}
+
+//----------------------------------------------------------------
+flxLoRaWANClockSync::flxLoRaWANClockSync()
+    : _pLoRaWAN{nullptr}, _epoch{0}, _epochTicks{0}, _isValid{false}, _sync_interval{kClockSyncDefaultInterval},
+      _serverPeriod{0}, _token{0}, _uplinkTimeMS{0}, _nSyncs{0}, _lastCorrection{0}
+{
+    setName("LoRaWAN Time", "Network time via the LoRaWAN connection");
+
+    flxRegister(syncInterval, "Sync Interval", "Hours between network time syncs - 0 to sync after a join only");
+
+    flux_add(this);
+}
+//----------------------------------------------------------------
+bool flxLoRaWANClockSync::setLoRaWAN(flxLoRaWANDigi *pLoRaWAN)
+{
+    if (pLoRaWAN == nullptr)
+        return false;
+
+    _pLoRaWAN = pLoRaWAN;
+
+    _syncJob.setup("LoRaWAN Time", kClockSyncJoinDelay, this, &flxLoRaWANClockSync::syncJobCB);
+
+    flxRegisterEventCB(flxEvent::kOnConnectionChange, this, &flxLoRaWANClockSync::onConnectionChange);
+
+    // Already connected? Start syncing
+    if (_pLoRaWAN->isConnected())
+        onConnectionChange(true);
+
+    return _pLoRaWAN->downlink().registerPortHandler(kLoRaWANClockSyncPort, this, &flxLoRaWANClockSync::onDownlink);
+}
+//----------------------------------------------------------------
+uint32_t flxLoRaWANClockSync::get_sync_interval(void)
+{
+    return _sync_interval;
+}
+
+void flxLoRaWANClockSync::set_sync_interval(uint32_t hours)
+{
+    _sync_interval = hours;
+}
+//----------------------------------------------------------------
+// flxIClock interface - the epoch runs from the board clock between syncs
+//
+uint32_t flxLoRaWANClockSync::get_epoch(void)
+{
+    if (!_isValid)
+        return 0;
+
+    return _epoch + (millis() - _epochTicks) / 1000;
+}
+
+void flxLoRaWANClockSync::set_epoch(const uint32_t &epoch)
+{
+    _epoch = epoch;
+    _epochTicks = millis();
+    _isValid = true;
+}
+
+bool flxLoRaWANClockSync::valid_epoch(void)
+{
+    return _isValid;
+}
+//----------------------------------------------------------------
+// Sync soon after a join - the network needs the join to complete before it can answer
+//
+void flxLoRaWANClockSync::onConnectionChange(bool bConnected)
+{
+    if (!bConnected)
+    {
+        flxRemoveJobFromQueue(_syncJob);
+        return;
+    }
+    _syncJob.setPeriod(kClockSyncJoinDelay);
+    flxAddJobToQueue(_syncJob);
+}
+//----------------------------------------------------------------
+void flxLoRaWANClockSync::syncJobCB(void)
+{
+    // if this request isn't answered, try again
+    _syncJob.setPeriod(kClockSyncRetryTime);
+    flxUpdateJobInQueue(_syncJob);
+
+    requestSync();
+}
+//----------------------------------------------------------------
+void flxLoRaWANClockSync::requestSync(void)
+{
+    if (_pLoRaWAN == nullptr || !_pLoRaWAN->isConnected())
+        return;
+
+    _token = (_token + 1) & kClockSyncTokenMask;
+
+    uint8_t message[6];
+    message[0] = kCmdAppTime;
+    packUInt32LE(deviceGPSTime(), message + 1);
+    message[5] = _token | kClockSyncAnsRequired;
+
+    // the module sends the request once queued - so it's received after its time on air
+    _uplinkTimeMS = (_pLoRaWAN->uplinkAirtime(sizeof(message)) + 500) / 1000;
+
+    sendMessage(message, sizeof(message));
+}
+//----------------------------------------------------------------
+void flxLoRaWANClockSync::onDownlink(uint8_t port, const uint8_t *payload, size_t len)
+{
+    if (payload == nullptr || len == 0)
+        return;
+
+    switch (payload[0])
+    {
+    case kCmdPackageVersion: {
+        uint8_t message[3] = {kCmdPackageVersion, kClockSyncPackageID, kClockSyncPackageVersion};
+        sendMessage(message, sizeof(message));
+        break;
+    }
+    case kCmdAppTime:
+        // AppTimeAns - correction (int32) and token
+        if (len < 6)
+            break;
+
+        if ((payload[5] & kClockSyncTokenMask) != _token)
+        {
+            flxLog_D(F("%s: Time answer token mismatch - ignored"), name());
+            break;
+        }
+        applyCorrection((int32_t)unpackUInt32LE(payload + 1));
+        break;
+
+    case kCmdAppTimePeriodicity: {
+        // Period - 128 * 2^N seconds. Used until the next restart - the setting isn't changed
+        if (len < 2)
+            break;
+
+        _serverPeriod = 128UL << (payload[1] & 0x0F);
+
+        uint8_t message[6];
+        message[0] = kCmdAppTimePeriodicity;
+        message[1] = 0; // status - supported
+        packUInt32LE(deviceGPSTime(), message + 2);
+        sendMessage(message, sizeof(message));
+        break;
+    }
+    case kCmdForceResync:
+        // resync now - via the job, so the transmit isn't made from within the downlink handler
+        flxRemoveJobFromQueue(_syncJob);
+        _syncJob.setPeriod(kClockSyncJoinDelay);
+        flxAddJobToQueue(_syncJob);
+        break;
+
+    default:
+        flxLog_W(F("%s: Unknown command 0x%02X"), name(), payload[0]);
+        break;
+    }
+}
+//----------------------------------------------------------------
+// The correction is relative to our time when the network received the request - the end of the uplink.
+// That was the time stamped in the request plus the time on air of the uplink. The transmit status isn't
+// used for this - it's reported after the receive windows, seconds after the uplink.
+//
+void flxLoRaWANClockSync::applyCorrection(int32_t correction)
+{
+    int32_t uplinkSecs = (_uplinkTimeMS + 500) / 1000;
+
+    set_epoch(deviceGPSTime() + kGPSEpochOffset - kGPSLeapSeconds + correction - uplinkSecs);
+
+    _lastCorrection = correction;
+    _nSyncs++;
+
+    flxLog_I(F("%s: Time synced - correction %d secs"), name(), correction);
+
+    // Update the system clock - if we're the reference clock
+    flxClock.updateClock();
+
+    // next sync
+    flxRemoveJobFromQueue(_syncJob);
+    if (_serverPeriod > 0 || _sync_interval > 0)
+    {
+        _syncJob.setPeriod(_serverPeriod > 0 ? _serverPeriod * 1000 : _sync_interval * 3600000);
+        flxAddJobToQueue(_syncJob);
+    }
+}
+//----------------------------------------------------------------
+// Our time as GPS time - the time of the system clock, until we have synced
+//
+uint32_t flxLoRaWANClockSync::deviceGPSTime(void)
+{
+    uint32_t now = _isValid ? get_epoch() : (uint32_t)time(nullptr);
+
+    return now - kGPSEpochOffset + kGPSLeapSeconds;
+}
+//----------------------------------------------------------------
+void flxLoRaWANClockSync::sendMessage(const uint8_t *message, size_t len)
+{
+    if (_pLoRaWAN == nullptr || !_pLoRaWAN->sendMessage(kLoRaWANClockSyncPort, message, len))
+        flxLog_D(F("%s: Unable to send a message"), name());
+}
@@ -0,0 +1,105 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Network time for boards without a RTC or GNSS - the LoRaWAN Application Layer Clock Synchronization
+// package (TS003), on port 202.
+//
+// After a join, and then periodically, the device sends its time in an AppTimeReq uplink. The network
+// server answers with the correction to apply. The sync object is a flux reference clock - the time
+// is kept as an epoch at a system tick, so it runs from the board clock between syncs.
+//
+// The time in the request is taken when the uplink is queued, but the network answers relative to when it
+// received the uplink - the end of the transmit. So the estimated time on air of the request is removed
+// from the correction. The estimate is at the lowest data rate of the region - if ADR has raised the rate,
+// the time is set early by up to that estimate (about 1 sec for EU868, less for US915).
+
+#include "flxLoRaWANDigi.h"
+#include <Flux/flxClock.h>
+#include <Flux/flxCore.h>
+#include <Flux/flxCoreJobs.h>
+
+// The LoRaWAN port for the clock sync package
+const uint8_t kLoRaWANClockSyncPort = 202;
+
+class flxLoRaWANClockSync : public flxActionType<flxLoRaWANClockSync>, public flxIClock
+{
+  private:
+    uint32_t get_sync_interval(void);
+    void set_sync_interval(uint32_t hours);
+
+  public:
+    // Package commands
+    static constexpr uint8_t kCmdPackageVersion = 0x00;
+    static constexpr uint8_t kCmdAppTime = 0x01;
+    static constexpr uint8_t kCmdAppTimePeriodicity = 0x02;
+    static constexpr uint8_t kCmdForceResync = 0x03;
+
+    flxLoRaWANClockSync();
+
+    // Connect to the LoRaWAN connection - registers the downlink handler
+    bool setLoRaWAN(flxLoRaWANDigi *pLoRaWAN);
+
+    // flxIClock interface
+    uint32_t get_epoch(void);
+    void set_epoch(const uint32_t &epoch);
+    bool valid_epoch(void);
+
+    // Request a time sync now
+    void requestSync(void);
+
+    // Downlink handler - internal
+    void onDownlink(uint8_t port, const uint8_t *payload, size_t len);
+
+    // Sync details - for status output
+    uint32_t syncCount(void)
+    {
+        return _nSyncs;
+    }
+    int32_t lastCorrection(void)
+    {
+        return _lastCorrection;
+    }
+    uint32_t lastUplinkTime(void)
+    {
+        return _uplinkTimeMS;
+    }
+
+    // Hours between time syncs - 0 syncs after a join only
+    flxPropertyRWUInt32<flxLoRaWANClockSync, &flxLoRaWANClockSync::get_sync_interval,
+                        &flxLoRaWANClockSync::set_sync_interval>
+        syncInterval = {0, 168};
+
+  private:
+    void onConnectionChange(bool bConnected);
+    void syncJobCB(void);
+    void sendMessage(const uint8_t *message, size_t len);
+    void applyCorrection(int32_t correction);
+    uint32_t deviceGPSTime(void);
+
+    flxLoRaWANDigi *_pLoRaWAN;
+
+    // the time - epoch at a tick
+    uint32_t _epoch;
+    uint32_t _epochTicks;
+    bool _isValid;
+
+    uint32_t _sync_interval;
+    uint32_t _serverPeriod; // sync period set by the network server (secs) - 0 if not set
+    flxJob _syncJob;
+
+    // the request in flight - and its estimated time from queued to received by the network (ms)
+    uint8_t _token;
+    uint32_t _uplinkTimeMS;
+
+    uint32_t _nSyncs;
+    int32_t _lastCorrection;
+};
@@ -9,6 +9,7 @@
  */
 
 #include "flxLoRaWANDigi.h"
+#include "flxJobMetrics.h"
 #include <Flux/flxCoreEvent.h>
 #include <Flux/flxNetwork.h>
 #include <Flux/flxSerial.h>
@@ -17,41 +18,77 @@
 // for network data endian conversion
 #include <lwip/def.h>
 
-#include <xbee_lr.h>
-#define kXBeeLRSerial Serial1
-#define kXBeeLRBaud 9600
+#include <FreeRTOS.h>
+#include <task.h>
+
+// The modem transport - the XBee LR module, or for development, a simulated modem
+#if defined(FLX_LORAWAN_SIMULATED_MODEM)
+#include "flxLoRaWANTransportSim.h"
+typedef flxLoRaWANTransportSim flxLoRaWANTransportModem;
+#else
+#include "flxLoRaWANTransportXBee.h"
+typedef flxLoRaWANTransportXBee flxLoRaWANTransportModem;
+#endif
 
 // Define a connection iteration value - exceed this, skip the connection
 
 #define kMaxConnectionTries 3
 
-// How often is the connection status checked ... in MS
-const uint32_t kLoRaWANUpdateHandlerTimeMS = 120000;
+// Tries to read the EUI from the module at startup
+#define kMaxModuleTries 3
+
+// Join state machine timing (ms) - between steps, between EUI reads and between join attempts
+const uint32_t kJoinStepTime = 50;
+const uint32_t kModuleRetryTime = 100;
+const uint32_t kConnectionRetryTime = 200;
+
+// How often the join job checks on the startup background join (ms)
+const uint32_t kBackgroundJoinCheckTime = 250;
+
+// Stack size for the background join task - in 32 bit words
+#define kBackgroundJoinStackSize 1024
+
+// How often is the connection status checked ... in MS.
+//
+// Connection state is tracked passively from the transmit status of each send, so this poll of the
+// module is just a long period fallback for when no data has been sent for a while (30 minutes)
+const uint32_t kLoRaWANUpdateHandlerTimeMS = 1800000;
 
 // Define times (in ms) for the reconnected job
 const uint32_t kReconnectInitialTime = 30000;
 // 1 hour
 const uint32_t kReconnectMaxTime = 3600000;
 
+// Jitter added to the reconnect time - up to 1/N of the period
+const uint32_t kReconnectJitterDivisor = 4;
+
+// The LoRaWAN port used for link health uplinks
+const uint8_t kLoRaWANHealthPort = 3;
+
 // For the process messages job - in ms.
 const uint32_t kProcessMessagesTime = 4000;
+
+// Spreading factor used for the time on air estimate - the lowest data rate (DR0) of the region. The module
+// uses ADR, so this is the worst case.
+const uint8_t kAirtimeSFUS915 = 10;
+const uint8_t kAirtimeSFEU868 = 12;
+
+// Run time accounting for our jobs
+static flxJobMetrics _metricsConnection("LoRaWAN Connection");
+static flxJobMetrics _metricsProcess("LoRaWAN Process");
+static flxJobMetrics _metricsReconnect("LoRaWAN Reconnect");
+static flxJobMetrics _metricsJoin("LoRaWAN Join");
+static flxJobMetrics _metricsHealth("LoRaWAN Health");
 //----------------------------------------------------------------
-// Callbacks for the XBee LR module - these are static functions
+// Callbacks for the LoRaWAN transport - these are static functions
 //
 //
-static void OnReceiveCallback(void *data)
+static void OnReceiveCallback(void *context, flxLoRaWANPacket_t *packet)
 {
-    XBeeLRPacket_t *packet = (XBeeLRPacket_t *)data;
-
-    // If the packet is on channel two and size of 4, let's post an event
-    if (packet->port == 2 && packet->payloadSize <= 4)
-    {
-        uint32_t message = 0;
-        memcpy(&message, packet->payload, packet->payloadSize);
+    // update our link stats, and queue the message for the downlink dispatcher
+    if (context)
+        ((flxLoRaWANDigi *)context)->_onLinkPacket(packet, true);
 
-        // Post an event
-        flxSendEvent(flxEvent::kLoRaWANReceivedMessage, message);
-    }
     // In verbose mode - log data if we received any
     if (flxIsLoggingVerbose() && packet->payloadSize > 0)
     {
@@ -65,20 +102,24 @@ static void OnReceiveCallback(void *data)
     }
 }
 //----------------------------------------------------------------
-// called by the XBee LR module when a send is completed
+// called by the LoRaWAN transport when a send is completed
 //
-static void OnSendCallback(void *data)
+static void OnSendCallback(void *context, flxLoRaWANPacket_t *packet)
 {
-    XBeeLRPacket_t *packet = (XBeeLRPacket_t *)data;
+    if (context)
+        ((flxLoRaWANDigi *)context)->_onLinkPacket(packet, false);
 
     // post an event for the send status
-    flxSendEvent(flxEvent::kLoRaWANSendStatus, packet->status == 0);
+    flxSendEvent(flxEvent::kLoRaWANSendStatus, packet->status == kLoRaWANTxStatusSuccess);
+
+    // and the raw status code - used to track the connection state without polling the module
+    flxSendEvent(flxEvent::kLoRaWANTxStatus, (uint32_t)packet->status);
 
     // verbose mode?
     if (flxIsLoggingVerbose())
     {
         // happy send
-        if (packet->status == 0)
+        if (packet->status == kLoRaWANTxStatusSuccess)
         {
             // this is a continuation from the send verbose message
             flxLog_N_("[");
@@ -109,10 +150,10 @@ static void OnSendCallback(void *data)
 
             switch (packet->status)
             {
-            case 0x01:
+            case kLoRaWANTxStatusAckFailed:
                 flxLog_N(F("ACK Failed"));
                 break;
-            case 0x022:
+            case kLoRaWANTxStatusNotConnected:
                 flxLog_N(F("Not Connected"));
                 break;
             default:
@@ -134,16 +175,9 @@ void flxLoRaWANDigi::set_isEnabled(bool bEnabled)
 
     _isEnabled = bEnabled;
 
+    // Try to connect .. if this fails, the join process will start reconnect mode
     if (_isEnabled)
-    {
-        // Try to connect ..
-        if (!connect())
-        {
-            // failed to connect - set the reconnect job
-            _reconnectJob.setPeriod(kReconnectInitialTime);
-            flxAddJobToQueue(_reconnectJob);
-        }
-    }
+        connect();
     else
         disconnect();
 }
@@ -157,14 +191,12 @@ bool flxLoRaWANDigi::get_isEnabled(void)
 // Some settings to the lora module require a system restart. This method will handle this
 void flxLoRaWANDigi::update_system_config(void)
 {
-    // have we setup the system yet -- if not, skip this
-    if (_pXBeeLR == nullptr)
+    // have we setup the module yet -- if not, skip this. The setup uses the current values
+    if (!_moduleInitialized)
         return;
 
-    // Mark this module as not configured. This will force a reconfiguration at boot.
-    _moduleConfigured = false;
-
-    // Save our settings
+    // Save our settings - the changed values are written to the module at boot, since they no longer
+    // match the module configuration fingerprint.
     flxSettings.save(this, true);
 
     // Indicate that the system needs restart
@@ -227,10 +259,11 @@ uint8_t flxLoRaWANDigi::get_lora_class(void)
 // method to capture setting the module class
 bool flxLoRaWANDigi::setupLoRaWANClass(void)
 {
-    if (!_isEnabled || _pXBeeLR == nullptr)
+    // note - the class is set after each join, so if the module isn't setup, the value is set later
+    if (!_isEnabled || _pModem == nullptr || !_moduleInitialized)
         return false;
 
-    bool status = _pXBeeLR->setLoRaWANClass(kLoRaWANClasses[_lora_class][0]);
+    bool status = _pModem->setClass(kLoRaWANClasses[_lora_class][0]);
     if (!status)
         flxLog_W(F("Failed setting the LoRaWAN Class to `%s`"), kLoRaWANClasses[_lora_class]);
     else
@@ -256,6 +289,56 @@ uint8_t flxLoRaWANDigi::get_lora_region(void)
 {
     return _lora_region;
 }
+//----------------------------------------------------------------
+void flxLoRaWANDigi::set_sub_band(uint8_t subBand)
+{
+    if (_sub_band == subBand)
+        return;
+
+    _sub_band = subBand;
+
+    update_system_config(); // we will need to restart the system to apply this change
+}
+
+uint8_t flxLoRaWANDigi::get_sub_band(void)
+{
+    return _sub_band;
+}
+//----------------------------------------------------------------
+// The channel mask for the module - a hex string of the channel bits, with channel 0 the low bit of
+// the last character.
+//
+// Only US915 uses a mask - 64 125 kHz channels in 8 sub-bands of 8 channels, and 8 500 kHz channels -
+// one per sub-band. Restricting the channels to the sub-band our gateways listen on (TTN uses
+// sub-band 2) means a join doesn't cycle through channels no gateway hears.
+
+std::string flxLoRaWANDigi::channelMask(void)
+{
+    if (strcmp(getRegionName(), "US915") != 0)
+        return "";
+
+    const uint8_t kUS915MaskBytes = 9; // 72 channels
+    uint8_t mask[kUS915MaskBytes];
+
+    if (_sub_band == 0)
+        memset(mask, 0xFF, sizeof(mask));
+    else
+    {
+        memset(mask, 0, sizeof(mask));
+
+        // 125 kHz channels of the sub-band - mask is big-endian, channel 0 is in the last byte
+        mask[kUS915MaskBytes - _sub_band] = 0xFF;
+
+        // 500 kHz channel of the sub-band - channels 64-71 are in the first byte
+        mask[0] = 1 << (_sub_band - 1);
+    }
+
+    char szMask[kUS915MaskBytes * 2 + 1];
+    for (int i = 0; i < kUS915MaskBytes; i++)
+        snprintf(szMask + i * 2, 3, "%02X", mask[i]);
+
+    return std::string(szMask);
+}
 const char *flxLoRaWANDigi::getRegionName(void)
 {
     for (int i = 0; i < sizeof(kLoRaWANRegionIDs) / sizeof(kLoRaWANRegionIDs[0]); i++)
@@ -266,229 +349,584 @@ const char *flxLoRaWANDigi::getRegionName(void)
     return "Unknown";
 }
 //----------------------------------------------------------------
+// Module configuration fingerprints
+//
+// The module stores its configuration in flash. To skip writing values it already has, a fingerprint
+// (FNV-1a hash) of each value written is kept in our settings. The field ID is mixed into the hash so
+// the same value in different fields has a different fingerprint.
+
+static uint32_t configFingerprint(uint8_t fieldID, const char *value)
+{
+    uint32_t hash = 2166136261u;
+
+    hash = (hash ^ fieldID) * 16777619u;
+    for (; value != nullptr && *value != '\0'; value++)
+        hash = (hash ^ (uint8_t)*value) * 16777619u;
+
+    return hash;
+}
+
+// Field IDs for the fingerprints
+const uint8_t kModCfgModule = 1;
+const uint8_t kModCfgAppEUI = 2;
+const uint8_t kModCfgAppKey = 3;
+const uint8_t kModCfgNwkKey = 4;
+const uint8_t kModCfgRegion = 5;
+const uint8_t kModCfgChannels = 6;
+
+// The API options written to the module
+//
+// 12/10/24 - If this is set to 0x11, not 0x1 - sendPacket() call on the Arduino XBee library will timeout
+// Waiting on a tx response.
+const uint8_t kXBeeLRApiOptions = 0x01;
+
+//----------------------------------------------------------------
+// Clear the module configuration fingerprints - forces a full configuration of the module
+void flxLoRaWANDigi::clearModuleConfig(void)
+{
+    _modCfgModule = 0;
+    _modCfgAppEUI = 0;
+    _modCfgAppKey = 0;
+    _modCfgNwkKey = 0;
+    _modCfgRegion = 0;
+    _modCfgChannels = 0;
+    _sessionCfg = 0;
+}
+//----------------------------------------------------------------
+// Fingerprint of the full module configuration
+uint32_t flxLoRaWANDigi::moduleConfigFingerprint(void)
+{
+    return _modCfgModule() ^ _modCfgAppEUI() ^ _modCfgAppKey() ^ _modCfgNwkKey() ^ _modCfgRegion() ^
+           _modCfgChannels();
+}
+//----------------------------------------------------------------
+// Output the status of a module configuration write
+static void logConfigStatus(bool status)
+{
+    if (!status)
+    {
+        flxSerial.textToYellow();
+        flxLog_N_(F("failed"));
+    }
+    else
+    {
+        flxSerial.textToGreen();
+        flxLog_N_(F("ok"));
+    }
+    flxSerial.textToNormal();
+    flxLog_N_(F("] "));
+}
+//----------------------------------------------------------------
 // Config the settings on the module. These settings are persistent, so only need to set once.
+//
+// Only values that differ from the fingerprint of what was last written to this module are written,
+// and the module configuration is only saved (module flash write) if something changed.
 
-bool flxLoRaWANDigi::configureModule(void)
+bool flxLoRaWANDigi::configureModule(bool &bChanged)
 {
-    if (!_isEnabled || _pXBeeLR == nullptr)
+    bChanged = false;
+
+    if (!_isEnabled || _pModem == nullptr)
         return false;
 
-    // Now initialize the module
+    // Is this the module we configured last? The ID is read back from the module at startup - if it
+    // changed, all values are written.
+    uint32_t fpModule = configFingerprint(kModCfgModule, _devEUI) ^ kXBeeLRApiOptions;
+    bool newModule = fpModule != _modCfgModule();
 
-    // App EUI
-    if (appEUI().size() > 0)
+    uint8_t nChanged = 0;
+    bool status;
+
+    // Region
+    uint32_t fpValue = configFingerprint(kModCfgRegion, getRegionName());
+    if (newModule || fpValue != _modCfgRegion())
     {
-        flxLog_N_("Setting App EUI: %s [", appEUI().c_str());
-        if (!_pXBeeLR->setLoRaWANAppEUI(appEUI().c_str()))
-        {
-            flxSerial.textToYellow();
-            flxLog_N_(F("failed"));
-        }
+        // note:
+        // TODO: this wasn't working in 12/2024 -- need to revisit in the future as the XBee LR library is updated
+        // Set the region
+        if (!_pModem->setRegion(_lora_region))
+            flxLog_W(F("%s: Error setting the LoRaWAN Region to `%s`"), name(), getRegionName());
         else
         {
-            flxSerial.textToGreen();
-            flxLog_N_(F("ok"));
+            flxLog_V(F("%s: Set the LoRaWAN Region to `%s`"), name(), getRegionName());
+            _modCfgRegion = fpValue;
+            nChanged++;
+
+            // a region change resets the channels on the module
+            _modCfgChannels = 0;
         }
-        flxSerial.textToNormal();
-        flxLog_N_(F("] "));
     }
-    flxLog_N_(F("."));
 
-    // App Key
-    if (appKey().size() > 0)
+    // Channel Mask - if the region uses one
+    std::string theMask = channelMask();
+    fpValue = configFingerprint(kModCfgChannels, theMask.c_str());
+    if (theMask.size() > 0 && (newModule || fpValue != _modCfgChannels()))
     {
-        flxLog_N_(F(". setting App Key ["));
-        if (!_pXBeeLR->setLoRaWANAppKey(appKey().c_str()))
+        flxLog_N_(F("Setting Channel Mask: %s ["), theMask.c_str());
+        status = _pModem->setChannelsMask(theMask.c_str());
+        logConfigStatus(status);
+        if (status)
         {
-            flxSerial.textToYellow();
-            flxLog_N_(F("failed"));
+            _modCfgChannels = fpValue;
+            nChanged++;
         }
-        else
+    }
+
+    // App EUI
+    fpValue = configFingerprint(kModCfgAppEUI, appEUI().c_str());
+    if (appEUI().size() > 0 && (newModule || fpValue != _modCfgAppEUI()))
+    {
+        flxLog_N_("Setting App EUI: %s [", appEUI().c_str());
+        status = _pModem->setAppEUI(appEUI().c_str());
+        logConfigStatus(status);
+        if (status)
         {
-            flxSerial.textToGreen();
-            flxLog_N_(F("ok"));
+            _modCfgAppEUI = fpValue;
+            nChanged++;
         }
-        flxSerial.textToNormal();
-        flxLog_N_(F("] "));
     }
 
-    flxLog_N_(F("."));
+    // App Key
+    fpValue = configFingerprint(kModCfgAppKey, appKey().c_str());
+    if (appKey().size() > 0 && (newModule || fpValue != _modCfgAppKey()))
+    {
+        flxLog_N_(F(". setting App Key ["));
+        status = _pModem->setAppKey(appKey().c_str());
+        logConfigStatus(status);
+        if (status)
+        {
+            _modCfgAppKey = fpValue;
+            nChanged++;
+        }
+    }
 
     // Network Key
-    if (networkKey().size() > 0)
+    fpValue = configFingerprint(kModCfgNwkKey, networkKey().c_str());
+    if (networkKey().size() > 0 && (newModule || fpValue != _modCfgNwkKey()))
     {
         flxLog_N_(F(". setting Network Key ["));
-        if (!_pXBeeLR->setLoRaWANNwkKey(networkKey().c_str()))
-        {
-            flxSerial.textToYellow();
-            flxLog_N_(F("failed"));
-        }
-        else
+        status = _pModem->setNwkKey(networkKey().c_str());
+        logConfigStatus(status);
+        if (status)
         {
-            flxSerial.textToGreen();
-            flxLog_N_(F("ok"));
+            _modCfgNwkKey = fpValue;
+            nChanged++;
         }
-        flxSerial.textToNormal();
-        flxLog_N_(F("] "));
     }
-    flxLog_N_(F("."));
 
-    // 12/10/24 - If this is set to 0x11, not 0x1 - sendPacket() call on the Arduino XBee library will timeout
-    // Waiting on a tx response.
-    if (!_pXBeeLR->setApiOptions(0x01))
-        flxLog_D(F("%s: Failed to set the API Options"), name());
+    // Options are only set on a new module
+    if (newModule)
+    {
+        if (!_pModem->setApiOptions(kXBeeLRApiOptions))
+            flxLog_D(F("%s: Failed to set the API Options"), name());
+        nChanged++;
+    }
 
-    flxLog_N_(F("."));
+    // Nothing changed? Then the module already has our configuration - skip the write
+    if (nChanged == 0)
+    {
+        flxLog_V(F("%s: Module configuration is current"), name());
+        return true;
+    }
 
     // Save the config to the module
-    if (!_pXBeeLR->writeConfig())
+    if (!_pModem->writeConfig())
     {
         flxLog_D(F("%s: Failed to write the module configuration"), name());
     }
 
-    flxLog_N_(F("."));
-
     // Apply the changes
-    if (!_pXBeeLR->applyChanges())
+    if (!_pModem->applyChanges())
     {
         flxLog_D(F("%s: Failed to apply the module configuration"), name());
     }
-    flxLog_N_(F("."));
+    flxLog_N(F("."));
+
+    // At this point, the changes are set in the LoRa module - save our fingerprints
+    bChanged = true;
+    _modCfgModule = fpModule;
+    flxSettings.save(this, true);
 
-    // At this point, the changes are set in the LoRa module
     return true;
 }
 //----------------------------------------------------------------
-// Setup the LoRaWAN Object
+void flxLoRaWANDigi::set_module_baud(uint32_t baudRate)
+{
+    if (_module_baud == baudRate)
+        return;
+
+    _module_baud = baudRate;
+
+    update_system_config(); // we will need to restart the system to apply this change
+}
+
+uint32_t flxLoRaWANDigi::get_module_baud(void)
+{
+    return _module_baud;
+}
+//----------------------------------------------------------------
+// Module setup steps - each is one step of the join state machine
+//----------------------------------------------------------------
+// Create or reset the module and start it up
 
-bool flxLoRaWANDigi::setupModule(void)
+bool flxLoRaWANDigi::moduleBegin(void)
 {
     // If we have a module, reset it
-    if (_pXBeeLR)
-        _pXBeeLR->reset();
+    if (_pModem)
+        _pModem->reset();
     else
     {
         // Create the module
-        _pXBeeLR = new XBeeArduino(&kXBeeLRSerial, kXBeeLRBaud, XBEE_LORA, OnReceiveCallback, OnSendCallback);
+        _pModem = new flxLoRaWANTransportModem;
 
         // no module - ahh - no dice.
-        if (!_pXBeeLR)
+        if (!_pModem)
         {
-            flxLog_E(F("%s: Failed to create the XBee LR module"), name());
+            flxLog_E(F("%s: Failed to create the LoRaWAN transport"), name());
             return false;
         }
+        _pModem->setCallbacks(OnReceiveCallback, OnSendCallback, this);
     }
-    flxLog_N_(F("."));
 
-    // Initialize the module
-    if (!_pXBeeLR->begin())
+    // Initialize the module - this also sets up the UART rate
+    if (!_pModem->begin(_module_baud))
     {
-        flxLog_E_(F("%s: Failed to initialize the XBee LR module"), name());
+        flxLog_E(F("%s: Failed to initialize the %s module"), name(), _pModem->name());
         return false;
     }
-    // This might take a few tries ...
-    bool status = false;
-    for (int i = 0; i < 3; i++)
-    {
-        flxLog_N_(F("."));
-        if (_pXBeeLR->getLoRaWANDevEUI(_devEUI, sizeof(_devEUI)))
-        {
-            status = true;
-            break;
-        }
-        delay(100);
-    }
-    if (!status)
-    {
-        flxLog_E_(F("%s: The XBee LR module failed to initialize"), name());
-        return false;
-    }
-    else
-        flxLog_V_(F("Device EUID: %s "), deviceEUI());
 
-    // note:
-    // TODO: this wasn't working in 12/2024 -- need to revisit in the future as the XBee LR library is updated
-    // Set the region
-    if (!_pXBeeLR->setLoRaWANRegion(_lora_region))
-        flxLog_W(F("%s: Error setting the LoRaWAN Region to `%s`"), name(), getRegionName());
+    _uartBaud = _pModem->uartRate();
+    if (_uartBaud != _module_baud)
+        flxLog_W(F("%s: Unable to set the module UART rate to %u"), name(), _module_baud);
     else
-        flxLog_V_(F("%s: Set the LoRaWAN Region to `%s`"), name(), getRegionName());
+        flxLog_V(F("%s: Module UART rate %u"), name(), _uartBaud);
 
-    flxLog_N_(F("."));
+    return true;
+}
+//----------------------------------------------------------------
+// Read the device EUI - this is the first command sent to the module after start, so might fail
+// while the module finishes its startup.
+
+bool flxLoRaWANDigi::moduleReadEUI(void)
+{
+    if (!_pModem->getDevEUI(_devEUI, sizeof(_devEUI)))
+        return false;
+
+    flxLog_V(F("%s: Device EUID: %s "), name(), deviceEUI());
+    return true;
+}
+//----------------------------------------------------------------
+// Set the region and configure the module
+
+bool flxLoRaWANDigi::moduleSetup(bool &bChanged)
+{
+    // Configure the module - only values that changed are written
+    if (!configureModule(bChanged))
+        return false;
 
-    // Do we need to configure the module?
-    if (_moduleConfigured() == false)
-    {
-        if (!configureModule())
-            return false;
-        _moduleConfigured = true;
-        // our setting for the module config has changed - save it
-        flxSettings.save(this, true);
-    }
     _moduleInitialized = true;
 
     return true;
 }
 //----------------------------------------------------------------
-// Connection Management
+// Make a join attempt
 
-bool flxLoRaWANDigi::connect(void)
+bool flxLoRaWANDigi::moduleJoin(void)
 {
+    _joinAttempts++;
+    return _pModem->connect();
+}
+//----------------------------------------------------------------
+// The module has joined the network
 
-    if (!_isEnabled)
+void flxLoRaWANDigi::joinComplete(bool bRestored)
+{
+    // We are connected -- make sure the class is set.
+    (void)setupLoRaWANClass();
+
+    // Record the session - if the module keeps it over a restart, no join is needed
+    if (_sessionCfg() != moduleConfigFingerprint())
+    {
+        _sessionCfg = moduleConfigFingerprint();
+        flxSettings.save(this, true);
+    }
+    // join metrics
+    _lastJoinMS = millis() - _joinStartTicks;
+    _lastJoinAttempts = _joinAttempts;
+    if (!bRestored)
+        _joinCount++;
+
+    flxLog_I(F("%s: %s"), name(), bRestored ? "Connected - network session restored" : "Connected");
+    flxLog_V(F("%s: Join time %u ms, %u attempts"), name(), _lastJoinMS, _lastJoinAttempts);
+    setJoinState(kJoinStateConnected);
+    setConnectionState(true);
+}
+//----------------------------------------------------------------
+// Is the network session from before a restart still valid? It must be for the current module
+// configuration, and the module must still be joined. If it is not, the node joins.
+
+bool flxLoRaWANDigi::sessionValid(void)
+{
+    return _sessionCfg() != 0 && _sessionCfg() == moduleConfigFingerprint() && _pModem->isConnected();
+}
+
+//----------------------------------------------------------------
+// Background join - at startup, the module is started and joined in a task, so this overlaps with
+// device discovery and settings restore. Once started, the join state machine picks up the results.
+//----------------------------------------------------------------
+static void _flxLoRaWANDigi_BackgroundJoin(void *parameter)
+{
+    ((flxLoRaWANDigi *)parameter)->_backgroundJoinProc();
+
+    vTaskDelete(NULL);
+}
+//----------------------------------------------------------------
+// Start the background join. If bJoin is true, the module joins using the configuration it has from a
+// previous boot - the configuration is checked and if needed, updated, once settings are restored.
+//
+// The UART rate is passed in - the settings are not restored yet.
+
+bool flxLoRaWANDigi::startBackgroundJoin(bool bJoin, uint32_t baudRate)
+{
+    if (_pModem != nullptr || _bgJoinStatus != kBgJoinNone)
         return false;
 
-    // are we already connected?
-    if (isConnected())
-        return true;
+    _module_baud = baudRate;
 
-    flxLog_I_(F(" Connecting to the LoRaWAN."));
+    // Create the module here - so only the task uses it until it's done
+    _pModem = new flxLoRaWANTransportModem;
+    if (!_pModem)
+        return false;
+    _pModem->setCallbacks(OnReceiveCallback, OnSendCallback, this);
 
-    if (!_moduleInitialized)
+    _bgJoin = bJoin;
+    _joinStartTicks = millis();
+    _joinAttempts = 0;
+    _bgJoinStatus = kBgJoinActive;
+
+    if (xTaskCreate(_flxLoRaWANDigi_BackgroundJoin, "loraJoin", kBackgroundJoinStackSize, this, 1, NULL) != pdPASS)
     {
-        if (!setupModule())
-            return false;
+        // no task - the module is setup when connect() is called
+        _bgJoinStatus = kBgJoinNone;
+        return false;
     }
+    return true;
+}
+//----------------------------------------------------------------
+// The background join task. Note - this runs outside of the main loop, so no logging or events, just
+// module operations.
+
+void flxLoRaWANDigi::_backgroundJoinProc(void)
+{
+    uint8_t status = kBgJoinFailed;
 
-    // This might take a few tries ...
-    bool status = false;
-    for (int i = 0; i < kMaxConnectionTries; i++)
+    if (_pModem->begin(_module_baud))
     {
-        flxLog_N_(F("."));
-        if (_pXBeeLR->connect())
+        _uartBaud = _pModem->uartRate();
+
+        // This might take a few tries ...
+        for (int i = 0; i < kMaxModuleTries; i++)
         {
-            status = true;
-            break;
+            if (_pModem->getDevEUI(_devEUI, sizeof(_devEUI)))
+            {
+                status = kBgJoinReady;
+                break;
+            }
+            vTaskDelay(kModuleRetryTime / portTICK_PERIOD_MS);
+        }
+
+        // Join using the configuration already on the module? Not if the module still has a session -
+        // that is checked against our settings once they are restored.
+        bool bJoin = _bgJoin && status == kBgJoinReady && !_pModem->isConnected();
+
+        for (int i = 0; bJoin && status == kBgJoinReady && i < kMaxConnectionTries; i++)
+        {
+            _joinAttempts++;
+            if (_pModem->connect())
+                status = kBgJoinJoined;
+            else
+                vTaskDelay(kConnectionRetryTime / portTICK_PERIOD_MS);
         }
-        delay(200);
     }
+    _bgJoinStatus = status;
+}
 
-    // Let's Connect!
-    if (!status)
+//----------------------------------------------------------------
+// Join State Machine
+//----------------------------------------------------------------
+const char *flxLoRaWANDigi::joinStateName(void)
+{
+    static const char *kJoinStateNames[] = {"Idle",        "Starting",  "Starting Module", "Reading EUI",
+                                            "Configuring", "Joining",   "Connected",       "Failed"};
+
+    return _joinState <= kJoinStateFailed ? kJoinStateNames[_joinState] : "Unknown";
+}
+//----------------------------------------------------------------
+// Move to a new state - the next step is run by the join job after the given delay.
+
+void flxLoRaWANDigi::setJoinState(joinState_t newState, uint32_t nextStepMS)
+{
+    if (newState != _joinState)
     {
-        flxSerial.textToRed();
-        flxLog_N(F("Failed!"));
-        flxSerial.textToNormal();
+        _joinState = newState;
+        _joinTries = 0;
 
-        return false;
+        flxLog_V(F("%s: %s"), name(), joinStateName());
+
+        // let the world know how the join is progressing
+        flxSendEvent(flxEvent::kLoRaWANJoinState, (uint32_t)_joinState);
     }
-    // We are connected -- make sure the class is set.
-    (void)setupLoRaWANClass();
 
-    flxSerial.textToGreen();
-    flxLog_N(F("Connected!"));
-    flxSerial.textToNormal();
+    // Are we done? If so, stop the join job
+    if (_joinState == kJoinStateIdle || _joinState == kJoinStateConnected || _joinState == kJoinStateFailed)
+    {
+        flxRemoveJobFromQueue(_joinJob);
+        return;
+    }
+
+    _joinJob.setPeriod(nextStepMS > 0 ? nextStepMS : kJoinStepTime);
+    flxUpdateJobInQueue(_joinJob);
+}
+//----------------------------------------------------------------
+// Join job callback - advance the state machine one step. Each step is a single exchange with the
+// module, so the rest of the system keeps running while a connection is made.
 
-    // okay, we're connected.
-    _wasConnected = true;
-    flxSendEvent(flxEvent::kOnConnectionChange, true);
+void flxLoRaWANDigi::joinJobCB(void)
+{
+    flxJobMetricsScope metrics(_metricsJoin, _joinJob);
 
-    // add the connection monitor job to the system
-    _connectionJob.setPeriod(kLoRaWANUpdateHandlerTimeMS);
-    flxAddJobToQueue(_connectionJob);
+    if (!_isEnabled)
+    {
+        setJoinState(kJoinStateIdle);
+        return;
+    }
+    switch (_joinState)
+    {
+    case kJoinStateBackground:
+        // Is the startup background join still running?
+        if (_bgJoinStatus == kBgJoinActive)
+            setJoinState(kJoinStateBackground, kBackgroundJoinCheckTime);
 
-    // And the message pump job
-    flxAddJobToQueue(_processJob);
+        else if (_bgJoinStatus == kBgJoinFailed)
+        {
+            _bgJoinStatus = kBgJoinNone;
+            flxLog_E(F("%s: The %s module failed to initialize"), name(), _pModem->name());
+            setJoinState(kJoinStateFailed);
+        }
+        else
+        {
+            // The module is started - now check the configuration
+            _bgJoined = _bgJoinStatus == kBgJoinJoined;
+            _bgJoinStatus = kBgJoinNone;
+            if (_uartBaud != _module_baud)
+                flxLog_W(F("%s: Unable to set the module UART rate to %u"), name(), _module_baud);
+            flxLog_V(F("%s: Device EUID: %s "), name(), deviceEUI());
+            setJoinState(kJoinStateConfigure);
+        }
+        break;
+
+    case kJoinStateModuleBegin:
+        if (moduleBegin())
+            setJoinState(kJoinStateReadEUI);
+        else
+            setJoinState(kJoinStateFailed);
+        break;
+
+    case kJoinStateReadEUI:
+        // This might take a few tries ...
+        if (moduleReadEUI())
+            setJoinState(kJoinStateConfigure);
+        else if (++_joinTries >= kMaxModuleTries)
+        {
+            flxLog_E(F("%s: The %s module failed to initialize"), name(), _pModem->name());
+            setJoinState(kJoinStateFailed);
+        }
+        else
+            setJoinState(kJoinStateReadEUI, kModuleRetryTime);
+        break;
+
+    case kJoinStateConfigure: {
+        bool bChanged;
+        if (!moduleSetup(bChanged))
+            setJoinState(kJoinStateFailed);
+
+        // Joined in the background with a configuration that is still current? Then we're done
+        else if (_bgJoined && !bChanged)
+            joinComplete();
+
+        // Does the module have a valid session from before a restart? No join needed.
+        else if (!bChanged && sessionValid())
+            joinComplete(true);
+        else
+        {
+            // joined with an old configuration? - leave that session, and join with the new one
+            if (_bgJoined || _pModem->isConnected())
+                _pModem->disconnect();
+            _sessionCfg = 0;
+            setJoinState(kJoinStateJoin);
+        }
+        _bgJoined = false;
+        break;
+    }
+    case kJoinStateJoin:
+        // This might take a few tries ...
+        if (moduleJoin())
+            joinComplete();
+        else if (++_joinTries >= kMaxConnectionTries)
+        {
+            flxLog_W(F("%s: Unable to connect"), name());
+            setJoinState(kJoinStateFailed);
+        }
+        else
+            setJoinState(kJoinStateJoin, kConnectionRetryTime);
+        break;
+
+    default:
+        setJoinState(_joinState);
+        break;
+    }
+
+    // if the join failed, the reconnect job will try again later
+    if (_joinState == kJoinStateFailed)
+        startReconnectMode();
+}
+//----------------------------------------------------------------
+// Connection Management
+//
+// Start a connection. This is non-blocking - the connection is made by the join job, with progress
+// posted via the kLoRaWANJoinState event and the final result via kOnConnectionChange.
+
+bool flxLoRaWANDigi::connect(void)
+{
+
+    if (!_isEnabled)
+        return false;
+
+    // are we already connected?
+    if (isConnected())
+        return true;
+
+    // join already in progress?
+    if (_joinState != kJoinStateIdle && _joinState != kJoinStateConnected && _joinState != kJoinStateFailed)
+        return true;
+
+    flxLog_I(F("%s: Connecting to the LoRaWAN"), name());
+
+    // Start at the required state - if the module was started in the background, pick up from there. If
+    // the module is setup, just join.
+    joinState_t startState = _moduleInitialized ? kJoinStateJoin : kJoinStateModuleBegin;
+    if (_bgJoinStatus != kBgJoinNone)
+        startState = kJoinStateBackground;
+    else
+    {
+        // start the join metrics - the background join started them at startup
+        _joinStartTicks = millis();
+        _joinAttempts = 0;
+    }
+
+    _joinState = kJoinStateIdle;
+    setJoinState(startState);
+    flxAddJobToQueue(_joinJob);
 
     return true;
 }
@@ -496,12 +934,21 @@ bool flxLoRaWANDigi::connect(void)
 //----------------------------------------------------------------
 void flxLoRaWANDigi::disconnect(void)
 {
-    if (!_pXBeeLR)
+    // stop any connection attempts
+    setJoinState(kJoinStateIdle);
+    flxRemoveJobFromQueue(_reconnectJob);
+    _inReconnect = false;
+
+    // no module, or the startup background task still owns it?
+    if (!_pModem || _bgJoinStatus == kBgJoinActive)
         return;
 
-    if (!_pXBeeLR->disconnect())
+    if (!_pModem->disconnect())
         flxLog_E(F("LoRaWAN disconnect() - error disconnecting"));
 
+    // left the network - no session to restore
+    _sessionCfg = 0;
+
     if (_wasConnected)
         flxSendEvent(flxEvent::kOnConnectionChange, false);
 
@@ -518,9 +965,10 @@ bool flxLoRaWANDigi::isConnected()
 {
     // We cache the connection status - so we don't have to check the module, which is *slow*.
     //
-    // The connection status is checked ever kLoRaWANUpdateHandlerTimeMS via a job
+    // The cached status is updated from the transmit status of every send, with the module only
+    // queried every kLoRaWANUpdateHandlerTimeMS via a job if the link has been quiet.
 
-    return _isEnabled && _pXBeeLR != nullptr && _wasConnected;
+    return _isEnabled && _pModem != nullptr && _wasConnected;
 }
 
 //----------------------------------------------------------------
@@ -540,8 +988,20 @@ bool flxLoRaWANDigi::initialize(void)
 
     flxRegister(loraWANRegion, "LoRaWAN Region", "The LoRaWAN operating region");
 
-    // our hidden module initialized property
-    flxRegister(_moduleConfigured, "mod-config");
+    flxRegister(loraWANSubBand, "US915 Sub-Band", "The channels used in the US915 region - match your gateways");
+
+    flxRegister(moduleBaudRate, "Module Baud Rate", "UART rate used with the LoRaWAN module");
+
+    flxRegister(healthInterval, "Health Interval", "Minutes between link health uplinks - 0 to disable");
+
+    // our hidden module configuration fingerprint properties
+    flxRegister(_modCfgModule, "mod-cfg-id");
+    flxRegister(_modCfgAppEUI, "mod-cfg-aeui");
+    flxRegister(_modCfgAppKey, "mod-cfg-akey");
+    flxRegister(_modCfgNwkKey, "mod-cfg-nkey");
+    flxRegister(_modCfgRegion, "mod-cfg-region");
+    flxRegister(_modCfgChannels, "mod-cfg-chan");
+    flxRegister(_sessionCfg, "session-cfg");
 
     // Register the reset module function/param
     flxRegister(resetModule, "Reset", "Reset the LoRaWAN module");
@@ -557,6 +1017,16 @@ bool flxLoRaWANDigi::initialize(void)
     // Our process messages job
     _processJob.setup("LoRaWAN Process", kProcessMessagesTime, this, &flxLoRaWANDigi::processMessagesCB);
 
+    // The join state machine job
+    _joinJob.setup("LoRaWAN Join", kJoinStepTime, this, &flxLoRaWANDigi::joinJobCB);
+
+    // Link health uplinks - the job is active when connected and an interval is set
+    _healthJob.setup("LoRaWAN Health", (_health_interval > 0 ? _health_interval : 60) * 60000, this,
+                     &flxLoRaWANDigi::healthJobCB);
+
+    // Track the connection state from the status of our transmits
+    flxRegisterEventCB(flxEvent::kLoRaWANTxStatus, this, &flxLoRaWANDigi::onTxStatus);
+
     // is it desired to delay the startup/connect call?
     if (_delayedStartup)
     {
@@ -571,28 +1041,19 @@ bool flxLoRaWANDigi::initialize(void)
 
 void flxLoRaWANDigi::reset_module(void)
 {
-    flxLog_I_(F("Resetting the LoRaWAN module.."));
+    flxLog_I(F("Resetting the LoRaWAN module.."));
 
-    // First, set our pref and persist it
-    _moduleConfigured = false;
+    // First, clear the module configuration fingerprint - forces a full configuration - and persist it
+    clearModuleConfig();
     flxSettings.save(this, true);
 
     // Disconnect
     disconnect();
 
-    // setup the module - this process will reconfigure/reset the module
-    if (!setupModule())
-    {
-        flxSerial.textToRed();
-        flxLog_N(F("failed"));
-        flxSerial.textToNormal();
-        return;
-    }
-    flxSerial.textToGreen();
-    flxLog_N(F("success"));
-    flxSerial.textToNormal();
+    // The join process will reset and reconfigure the module. If not enabled, this happens
+    // when the connection is enabled.
+    _moduleInitialized = false;
 
-    // Is the device enabled/up - call connected?
     if (_isEnabled)
         connect();
 }
@@ -604,7 +1065,12 @@ void flxLoRaWANDigi::reset_module(void)
 ///
 bool flxLoRaWANDigi::sendPayload(const uint8_t *payload, size_t len)
 {
-    if (payload == nullptr || len == 0 || _pXBeeLR == nullptr)
+    return sendMessage(_dataPort, payload, len);
+}
+//----------------------------------------------------------------
+bool flxLoRaWANDigi::sendMessage(uint8_t port, const uint8_t *payload, size_t len)
+{
+    if (payload == nullptr || len == 0 || _pModem == nullptr)
         return false;
 
     if (!isConnected())
@@ -614,95 +1080,264 @@ bool flxLoRaWANDigi::sendPayload(const uint8_t *payload, size_t len)
 
     if (flxIsLoggingVerbose())
     {
-        flxLog_V_(F("[%s] Sending packet: 0x"), name());
+        flxLog_V_(F("[%s] Sending packet (port %u): 0x"), name(), port);
         for (int i = 0; i < len; i++)
         {
             flxLog_N_(F("%02X"), payload[i]);
         }
         flxLog_N_(" - ");
     }
-    XBeeLRPacket_t packet;
-    packet.payload = (uint8_t *)payload;
-    packet.payloadSize = len;
-    packet.port = 2;
-    packet.ack = 0;
+    if (!_pModem->sendData(port, payload, len, false))
+        return false;
 
-    return _pXBeeLR->sendData(packet);
+    recordTxAirtime(len);
+    return true;
 }
 //----------------------------------------------------------------
-// Connection Status Callback
-// This is called by the connection job to check the connection status of the module
+// FNV-1a hash of the device EUI
 //
-void flxLoRaWANDigi::connectionStatusCB(void)
+uint32_t flxLoRaWANDigi::deviceEUIHash(void)
 {
-    // Connection change???
-    if (!_isEnabled || _pXBeeLR == nullptr)
-        return;
+    if (_devEUI[0] == '\0')
+        return 0;
 
-    // check the connection status of the module
-    bool isConn = _pXBeeLR->isConnected();
+    uint32_t hash = 2166136261UL;
+    for (const char *pChar = _devEUI; *pChar != '\0'; pChar++)
+        hash = (hash ^ (uint8_t)*pChar) * 16777619UL;
 
-    // flxLog_I(F("Connection Status: %s"), isConn ? "Connected" : "Disconnected");
+    return hash;
+}
+//----------------------------------------------------------------
+// Add the estimated time on air of an uplink to the link stats - used for the power estimate
+//
+void flxLoRaWANDigi::recordTxAirtime(size_t len)
+{
+    _linkStats.recordTxAirtime(len, airtimeSpreadingFactor());
+}
+
+uint32_t flxLoRaWANDigi::uplinkAirtime(size_t len)
+{
+    return flxLoRaWANLinkStats::airtime(len, airtimeSpreadingFactor());
+}
 
+uint8_t flxLoRaWANDigi::airtimeSpreadingFactor(void)
+{
+    return strcmp(getRegionName(), "US915") == 0 ? kAirtimeSFUS915 : kAirtimeSFEU868;
+}
+//----------------------------------------------------------------
+// Update the cached connection state - if the connection was lost, drop into reconnect mode
+//
+void flxLoRaWANDigi::setConnectionState(bool isConn)
+{
     // changed state?
-    if (isConn != _wasConnected)
+    if (isConn == _wasConnected)
+        return;
+
+    _wasConnected = isConn;
+
+    if (_wasConnected)
     {
-        _wasConnected = isConn;
-        flxSendEvent(flxEvent::kOnConnectionChange, _wasConnected);
+        // a successful join is as good as a confirmed transmit
+        _lastLinkOKTicks = millis();
+
+        // add the connection monitor job to the system
+        _connectionJob.setPeriod(kLoRaWANUpdateHandlerTimeMS);
+        flxAddJobToQueue(_connectionJob);
+
+        // And the message pump job
+        flxAddJobToQueue(_processJob);
+
+        // link health uplinks?
+        if (_health_interval > 0)
+            flxAddJobToQueue(_healthJob);
+
+        // no longer need to reconnect
+        flxRemoveJobFromQueue(_reconnectJob);
+        _inReconnect = false;
     }
-    // If we lost connection -  crank up reconnect mode
-    if (!_wasConnected)
+    else
     {
-        // if we lost connection, but are still enabled -- which we are at this point --
+        // If we lost connection - but are still enabled -- which we are at this point --
         // kick off the reconnect job
-        _reconnectJob.setPeriod(kReconnectInitialTime);
-        flxAddJobToQueue(_reconnectJob);
+        if (_joinState == kJoinStateConnected)
+            setJoinState(kJoinStateIdle);
+
+        startReconnectMode();
 
         // remove the connection check job -- will be relaunched when we reconnect
         flxRemoveJobFromQueue(_connectionJob);
 
         // remove our message pump
         flxRemoveJobFromQueue(_processJob);
+        flxRemoveJobFromQueue(_healthJob);
+    }
+    flxSendEvent(flxEvent::kOnConnectionChange, _wasConnected);
+}
+//----------------------------------------------------------------
+// Transmit status event handler - the status of each send tells us the state of the connection,
+// so a lost connection is detected on the next send, without having to query the module.
+//
+void flxLoRaWANDigi::onTxStatus(uint32_t status)
+{
+    if (!_isEnabled || _pModem == nullptr || !_wasConnected)
+        return;
+
+    if (status == kLoRaWANTxStatusSuccess)
+        _lastLinkOKTicks = millis();
+
+    else if (status == kLoRaWANTxStatusNotConnected)
+    {
+        flxLog_W(F("%s: connection lost"), name());
+        setConnectionState(false);
+    }
+}
+//----------------------------------------------------------------
+// Link statistics - updated from each packet the transport reports
+
+void flxLoRaWANDigi::_onLinkPacket(flxLoRaWANPacket_t *packet, bool bDownlink)
+{
+    if (!packet)
+        return;
+
+    _linkStats.recordSignal(packet->rssi, packet->snr);
+
+    if (bDownlink)
+    {
+        _linkStats.recordDownlink(packet->counter, millis());
+
+        // Buffer the message - it's dispatched after the modem processing is complete, so handlers can
+        // use the modem (send a response).
+        if (packet->payloadSize == 0 || packet->payloadSize > flxLoRaWANDownlink::kMaxPayload)
+            return;
+
+        if (_downlinkLen > 0)
+            flxLog_W(F("%s: Downlink on port %u dropped"), name(), _downlinkPort);
+
+        memcpy(_downlinkBuffer, packet->payload, packet->payloadSize);
+        _downlinkLen = packet->payloadSize;
+        _downlinkPort = packet->port;
+    }
+    else
+        _linkStats.recordTx(packet->status, packet->status == kLoRaWANTxStatusSuccess);
+}
+//----------------------------------------------------------------
+// Health uplink - a compact summary of the link statistics, sent on its own port
+
+void flxLoRaWANDigi::healthJobCB(void)
+{
+    flxJobMetricsScope metrics(_metricsHealth, _healthJob);
+
+    if (!isConnected() || _healthSuspended)
+        return;
+
+    uint8_t payload[flxLoRaWANLinkStats::kHealthPayloadSize];
+    size_t len = _linkStats.packHealth(payload, sizeof(payload), millis());
+
+    if (len == 0)
+        return;
+
+    if (!sendMessage(kLoRaWANHealthPort, payload, len))
+        flxLog_D(F("%s: Failed to send the link health uplink"), name());
+}
+//----------------------------------------------------------------
+void flxLoRaWANDigi::set_health_interval(uint32_t minutes)
+{
+    if (_health_interval == minutes)
+        return;
+
+    _health_interval = minutes;
+
+    // update the job - if running
+    flxRemoveJobFromQueue(_healthJob);
+    if (_health_interval > 0)
+    {
+        _healthJob.setPeriod(_health_interval * 60000);
+        if (_wasConnected)
+            flxAddJobToQueue(_healthJob);
     }
 }
 
+uint32_t flxLoRaWANDigi::get_health_interval(void)
+{
+    return _health_interval;
+}
+//----------------------------------------------------------------
+// Connection Status Callback
+// This is called by the connection job to check the connection status of the module
+//
+void flxLoRaWANDigi::connectionStatusCB(void)
+{
+    flxJobMetricsScope metrics(_metricsConnection, _connectionJob);
+
+    // Connection change???
+    if (!_isEnabled || _pModem == nullptr)
+        return;
+
+    // If a transmit was confirmed during this period, the link is up - no need to query the module
+    if (_wasConnected && millis() - _lastLinkOKTicks < kLoRaWANUpdateHandlerTimeMS)
+        return;
+
+    // check the connection status of the module
+    bool isConn = _pModem->isConnected();
+
+    // flxLog_I(F("Connection Status: %s"), isConn ? "Connected" : "Disconnected");
+
+    if (isConn)
+        _lastLinkOKTicks = millis();
+
+    setConnectionState(isConn);
+}
+
 //----------------------------------------------------------------
 // Job called to process any LoRaWAN messages
 void flxLoRaWANDigi::processMessagesCB(void)
 {
-    if (!_isEnabled || _pXBeeLR == nullptr)
+    flxJobMetricsScope metrics(_metricsProcess, _processJob);
+
+    if (!_isEnabled || _pModem == nullptr)
         return;
 
-    _pXBeeLR->process();
+    _pModem->process();
+
+    // Downlink to dispatch?
+    if (_downlinkLen > 0)
+    {
+        size_t len = _downlinkLen;
+        _downlinkLen = 0;
+
+        if (!_downlink.dispatch(_downlinkPort, _downlinkBuffer, len))
+            flxLog_V(F("%s: No handler for downlink - port %u, opcode 0x%02X"), name(), _downlinkPort,
+                     _downlinkBuffer[0]);
+    }
 }
 //----------------------------------------------------------------
 // Reconnect Job Callback
 //
 void flxLoRaWANDigi::reconnectJobCB(void)
 {
-    // If we're enabled, and not connected, try to connect
-    if (isConnected())
-    {
-        // We have reconnected, so remove this job
-        flxRemoveJobFromQueue(_reconnectJob);
-        return;
-    }
+    flxJobMetricsScope metrics(_metricsReconnect, _reconnectJob);
 
-    // We are not connected, but want to be - Try to connect
-    if (connect())
+    // If we're enabled, and not connected, try to connect
+    if (isConnected() || !_isEnabled)
     {
         // We have reconnected, so remove this job
         flxRemoveJobFromQueue(_reconnectJob);
+        _inReconnect = false;
         return;
     }
 
-    // We failed to connect -  - do we need to adjust the time on this job?
+    // We are not connected, but want to be - Try to connect. The join runs in the background - on
+    // success this job is removed, on failure it runs again at the next period.
+    connect();
 
+    // do we need to adjust the time on this job?
     uint32_t currentPeriod = _reconnectJob.period();
     if (currentPeriod < kReconnectMaxTime)
     {
-        // double delay (simple backoff strategy)
+        // double delay (simple backoff strategy). Add some jitter, so nodes that lost the network at the
+        // same time (power outage, gateway restart) don't all join at the same time.
         currentPeriod *= 2;
+        currentPeriod += rp2040.hwrand32() % (currentPeriod / kReconnectJitterDivisor);
         if (currentPeriod > kReconnectMaxTime)
             currentPeriod = kReconnectMaxTime;
         _reconnectJob.setPeriod(currentPeriod);
@@ -716,9 +1351,10 @@ void flxLoRaWANDigi::reconnectJobCB(void)
 //
 void flxLoRaWANDigi::startReconnectMode(void)
 {
-    // if we are enabled, start the reconnect job
-    if (_isEnabled)
+    // if we are enabled, and not already reconnecting, start the reconnect job
+    if (_isEnabled && !_inReconnect)
     {
+        _inReconnect = true;
         _reconnectJob.setPeriod(kReconnectInitialTime);
         flxAddJobToQueue(_reconnectJob);
     }
@@ -732,7 +1368,7 @@ void flxLoRaWANDigi::startReconnectMode(void)
 bool flxLoRaWANDigi::checkBuffer(size_t len)
 {
     // Make sure we have room for the data of the given size
-    if (!_isEnabled || _pXBeeLR == nullptr || len == 0 || len > kLoRaBufferLen || !isConnected())
+    if (!_isEnabled || _pModem == nullptr || len == 0 || len > kLoRaBufferLen || !isConnected())
         return false;
 
     if (len > kLoRaBufferLen)
@@ -850,4 +1486,21 @@ bool flxLoRaWANDigi::flushBuffer(void)
 {
     // just check the buffer with max size requested
     return checkBuffer(kLoRaBufferLen);
+}
+
+//------------------------------------------------------------------------------------------
+void flxLoRaWANDigi::setDataPort(uint8_t port)
+{
+    if (port == _dataPort)
+        return;
+
+    // pending data goes out on the current port - if it can't be sent, it's dropped
+    if (_currentOffset > 0)
+    {
+        flushBuffer();
+        _currentOffset = 0;
+        memset(_packetBuffer, 0, kLoRaBufferLen);
+    }
+
+    _dataPort = port;
 }
\ No newline at end of file
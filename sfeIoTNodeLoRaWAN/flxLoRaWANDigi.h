@@ -10,17 +10,26 @@
 
 #pragma once
 
-// Header file for the Digi LoRaWAN communication connection - works with the XBee LR module
+// Header file for the Digi LoRaWAN communication connection - works with the XBee LR module, via the
+// LoRaWAN transport interface
 
 #include <Flux/flxCoreJobs.h>
 #include <Flux/flxFlux.h>
 
-#include <XBeeArduino.h>
+#include "flxLoRaWANDownlink.h"
+#include "flxLoRaWANLinkStats.h"
+#include "flxLoRaWANTransport.h"
+#include <atomic>
 
 // Setup an event
 flxDefineEventID(kLoRaWANSendStatus);
-// Event for received messages
-flxDefineEventID(kLoRaWANReceivedMessage);
+// Event for the raw transmit status code reported by the module
+flxDefineEventID(kLoRaWANTxStatus);
+// Event for progress of the join state machine - the value is the new state
+flxDefineEventID(kLoRaWANJoinState);
+
+// The LoRaWAN port used for our data uplinks
+const uint8_t kLoRaWANDataPort = 2;
 
 // Our Development App EUI
 #define kDevelopmentAppEUI "37D56A3F6CDCF0A5"
@@ -56,12 +65,29 @@ class flxLoRaWANDigi : public flxActionType<flxLoRaWANDigi>
     uint8_t get_lora_region(void);
     uint8_t _lora_region;
 
+    void set_sub_band(uint8_t);
+    uint8_t get_sub_band(void);
+    uint8_t _sub_band;
+
+    void set_module_baud(uint32_t);
+    uint32_t get_module_baud(void);
+    uint32_t _module_baud;
+
+    void set_health_interval(uint32_t);
+    uint32_t get_health_interval(void);
+    uint32_t _health_interval;
+    bool _healthSuspended;
+
   public:
     // ctor
     flxLoRaWANDigi()
-        : _app_key{""}, _network_key{""}, _lora_class{2}, _lora_region{kLoRaWANRegionIDs[0]}, _wasConnected{false},
-          _isEnabled{true}, _delayedStartup{false}, _moduleInitialized{false}, _pXBeeLR{nullptr}, _devEUI{'\0'},
-          _currentOffset{0}
+        : _app_key{""}, _network_key{""}, _lora_class{2}, _lora_region{kLoRaWANRegionIDs[0]}, _sub_band{0},
+          _module_baud{kLoRaWANModuleBaudRates[1]}, _health_interval{0}, _healthSuspended{false}, _wasConnected{false},
+          _inReconnect{false}, _isEnabled{true}, _delayedStartup{false}, _moduleInitialized{false}, _lastLinkOKTicks{0},
+          _joinState{kJoinStateIdle}, _joinTries{0}, _joinStartTicks{0}, _joinAttempts{0}, _lastJoinMS{0},
+          _lastJoinAttempts{0}, _joinCount{0}, _uartBaud{0}, _bgJoinStatus{kBgJoinNone}, _bgJoin{false}, _bgJoined{false},
+          _pModem{nullptr}, _downlinkLen{0}, _downlinkPort{0}, _devEUI{'\0'},
+          _currentOffset{0}, _packetBuffer{0}, _dataPort{kLoRaWANDataPort}
     {
         setName("LoRaWAN Network", "Digi LoRaWAN connection for the system");
         flux_add(this);
@@ -77,11 +103,11 @@ class flxLoRaWANDigi : public flxActionType<flxLoRaWANDigi>
     // dtor
     ~flxLoRaWANDigi()
     {
-        if (_pXBeeLR)
+        if (_pModem)
         {
-            _pXBeeLR->disconnect();
-            delete _pXBeeLR;
-            _pXBeeLR = nullptr;
+            _pModem->disconnect();
+            delete _pModem;
+            _pModem = nullptr;
         }
     }
 
@@ -101,14 +127,94 @@ class flxLoRaWANDigi : public flxActionType<flxLoRaWANDigi>
             kLoRaWANRegionIDs[0],
             {{kLoRaWANRegionNames[0], kLoRaWANRegionIDs[0]}, {kLoRaWANRegionNames[1], kLoRaWANRegionIDs[1]}}};
 
-    flxPropertyHiddenBool<flxLoRaWANDigi> _moduleConfigured = {false};
+    // US915 channel sub-band - 0 is all channels
+    flxPropertyRWUInt8<flxLoRaWANDigi, &flxLoRaWANDigi::get_sub_band, &flxLoRaWANDigi::set_sub_band> loraWANSubBand =
+        {0,
+         {{"All Channels", 0},
+          {"Sub-Band 1", 1},
+          {"Sub-Band 2", 2},
+          {"Sub-Band 3", 3},
+          {"Sub-Band 4", 4},
+          {"Sub-Band 5", 5},
+          {"Sub-Band 6", 6},
+          {"Sub-Band 7", 7},
+          {"Sub-Band 8", 8}}};
+
+    // UART rate used with the module - negotiated with the module at startup
+    flxPropertyRWUInt32<flxLoRaWANDigi, &flxLoRaWANDigi::get_module_baud, &flxLoRaWANDigi::set_module_baud>
+        moduleBaudRate = {kLoRaWANModuleBaudRates[1],
+                          {{"9600", kLoRaWANModuleBaudRates[0]},
+                           {"115200", kLoRaWANModuleBaudRates[1]},
+                           {"230400", kLoRaWANModuleBaudRates[2]}}};
+
+    // Minutes between link health uplinks - 0 is disabled
+    flxPropertyRWUInt32<flxLoRaWANDigi, &flxLoRaWANDigi::get_health_interval, &flxLoRaWANDigi::set_health_interval>
+        healthInterval = {0, 10080};
+
+    // Fingerprints of the configuration values written to the module
+    flxPropertyHiddenUInt32<flxLoRaWANDigi> _modCfgModule = {0};
+    flxPropertyHiddenUInt32<flxLoRaWANDigi> _modCfgAppEUI = {0};
+    flxPropertyHiddenUInt32<flxLoRaWANDigi> _modCfgAppKey = {0};
+    flxPropertyHiddenUInt32<flxLoRaWANDigi> _modCfgNwkKey = {0};
+    flxPropertyHiddenUInt32<flxLoRaWANDigi> _modCfgRegion = {0};
+    flxPropertyHiddenUInt32<flxLoRaWANDigi> _modCfgChannels = {0};
+
+    // Module configuration fingerprint of the active network session - 0 if no session
+    flxPropertyHiddenUInt32<flxLoRaWANDigi> _sessionCfg = {0};
 
     // input params/functions
     flxParameterInVoid<flxLoRaWANDigi, &flxLoRaWANDigi::reset_module> resetModule;
 
+    // States of the connection/join state machine
+    typedef enum
+    {
+        kJoinStateIdle = 0,    // not connecting
+        kJoinStateBackground,  // waiting on the startup background join
+        kJoinStateModuleBegin, // create/reset and start the module
+        kJoinStateReadEUI,     // read the device EUI from the module
+        kJoinStateConfigure,   // set the region and configure the module
+        kJoinStateJoin,        // join the network
+        kJoinStateConnected,   // connected to the network
+        kJoinStateFailed       // the join failed - reconnect mode will try again
+    } joinState_t;
+
+    // Starts a connection - non-blocking. Returns true if connected or a connection is in progress
     bool connect(void);
     void disconnect(void);
 
+    // Start the module - and if it was configured on a previous boot, join - in a background task.
+    // Used at startup so the join overlaps device discovery and settings restore.
+    bool startBackgroundJoin(bool bJoin, uint32_t baudRate);
+
+    // background join task body - internal
+    void _backgroundJoinProc(void);
+
+    // update link statistics from a transport packet - internal
+    void _onLinkPacket(flxLoRaWANPacket_t *packet, bool bDownlink);
+
+    const flxLoRaWANLinkStats &linkStats(void)
+    {
+        return _linkStats;
+    }
+
+    // The modem transport - nullptr until the module is started
+    flxLoRaWANTransport *transport(void)
+    {
+        return _pModem;
+    }
+
+    // The downlink dispatcher - register handlers for downlink messages with this object
+    flxLoRaWANDownlink &downlink(void)
+    {
+        return _downlink;
+    }
+
+    joinState_t joinState(void)
+    {
+        return _joinState;
+    }
+    const char *joinStateName(void);
+
     bool isConnected();
 
     bool initialize(void);
@@ -126,6 +232,9 @@ class flxLoRaWANDigi : public flxActionType<flxLoRaWANDigi>
         return _devEUI;
     }
 
+    // A hash of the device EUI - a per device value for spreading uplink times. 0 if the EUI isn't known
+    uint32_t deviceEUIHash(void);
+
     // methods to send data to the LoRaWAN module - based on data size.
     bool sendData(uint8_t tag, bool data);
     bool sendData(uint8_t tag, int8_t data);
@@ -139,18 +248,80 @@ class flxLoRaWANDigi : public flxActionType<flxLoRaWANDigi>
     bool sendData(uint8_t tag, const uint8_t *data, size_t len);
     bool flushBuffer(void);
 
+    // The port the packed data is sent on - changing the port flushes the pending data
+    void setDataPort(uint8_t port);
+    uint8_t dataPort(void)
+    {
+        return _dataPort;
+    }
+
+    // Suspend the link health uplinks - without changing the health interval setting. Used to save power.
+    void suspendHealth(bool bSuspend)
+    {
+        _healthSuspended = bSuspend;
+    }
+
+    // Send a message on an application port - used by services with their own port (not the data buffer)
+    bool sendMessage(uint8_t port, const uint8_t *payload, size_t len);
+
+    // Estimated time on air (us) of an uplink of the given payload size - at the lowest data rate of the
+    // region, so the most it takes
+    uint32_t uplinkAirtime(size_t len);
+
     static constexpr const char *kLoRaWANClasses[3] = {"A", "B", "C"};
     static constexpr const char *kLoRaWANRegionNames[2] = {"US915", "EU868"};
     static constexpr uint8_t kLoRaWANRegionIDs[2] = {8, 5};
 
+    // UART rates supported with the module - the first is the module default
+    static constexpr uint32_t kLoRaWANModuleBaudRates[3] = {9600, 115200, 230400};
+
     const char *getRegionName(void);
 
+    // Fingerprint of the configuration last written to the module
+    uint32_t moduleConfigFingerprint(void);
+
+    // The channel mask for the current region/sub-band - empty if the region doesn't use one
+    std::string channelMask(void);
+
+    // Join metrics - time (ms) and join attempts of the last join, and joins since startup
+    uint32_t lastJoinTime(void)
+    {
+        return _lastJoinMS;
+    }
+    uint32_t lastJoinAttempts(void)
+    {
+        return _lastJoinAttempts;
+    }
+    uint32_t joinCount(void)
+    {
+        return _joinCount;
+    }
+
+    // The UART rate in use with the module - 0 if the module didn't respond
+    uint32_t moduleUARTRate(void)
+    {
+        return _uartBaud;
+    }
+
   private:
     void connectionStatusCB(void);
-    bool setupModule(void);
-    bool configureModule(void);
+    void onTxStatus(uint32_t status);
+    void setConnectionState(bool isConn);
+    void recordTxAirtime(size_t len);
+    uint8_t airtimeSpreadingFactor(void);
+    void setJoinState(joinState_t newState, uint32_t nextStepMS = 0);
+    void joinJobCB(void);
+    bool moduleBegin(void);
+    bool moduleReadEUI(void);
+    bool moduleSetup(bool &bChanged);
+    bool moduleJoin(void);
+    void joinComplete(bool bRestored = false);
+    bool sessionValid(void);
+    bool configureModule(bool &bChanged);
+    void clearModuleConfig(void);
     void reconnectJobCB(void);
     void processMessagesCB(void);
+    void healthJobCB(void);
     bool setupLoRaWANClass(void);
 
     // send our payload buffer
@@ -162,26 +333,71 @@ class flxLoRaWANDigi : public flxActionType<flxLoRaWANDigi>
 
     // flag used to help with connection changes.
     bool _wasConnected;
+    bool _inReconnect;
     bool _isEnabled;
     bool _delayedStartup;
 
     bool _moduleInitialized;
 
+    // ticks of the last transmit the module confirmed - proof the link is up
+    uint32_t _lastLinkOKTicks;
+
+    // join state machine - current state and the number of tries in that state
+    joinState_t _joinState;
+    uint8_t _joinTries;
+
+    // join metrics
+    uint32_t _joinStartTicks;
+    uint32_t _joinAttempts;
+    uint32_t _lastJoinMS;
+    uint32_t _lastJoinAttempts;
+    uint32_t _joinCount;
+
+    // the negotiated UART rate
+    uint32_t _uartBaud;
+
+    // Status of the startup background join task
+    static constexpr uint8_t kBgJoinNone = 0;
+    static constexpr uint8_t kBgJoinActive = 1;
+    static constexpr uint8_t kBgJoinFailed = 2;
+    static constexpr uint8_t kBgJoinReady = 3;
+    static constexpr uint8_t kBgJoinJoined = 4;
+
+    std::atomic<uint8_t> _bgJoinStatus;
+    bool _bgJoin;
+    bool _bgJoined;
+
     // our job for the connection status
     flxJob _connectionJob;
 
     // our job for reconnection
     flxJob _reconnectJob;
 
-    // The XBee processing messages (incoming) job
+    // The modem processing messages (incoming) job
     flxJob _processJob;
 
-    // Our XBee object for the LoRaWAN module
-    XBeeArduino *_pXBeeLR;
+    // Job that advances the join state machine - one step per call
+    flxJob _joinJob;
+
+    // Job for the link health uplink
+    flxJob _healthJob;
+
+    // rolling link quality statistics
+    flxLoRaWANLinkStats _linkStats;
+
+    // Our modem transport for the LoRaWAN module
+    flxLoRaWANTransport *_pModem;
+
+    // downlink dispatcher - and the buffered message waiting to be dispatched
+    flxLoRaWANDownlink _downlink;
+    uint8_t _downlinkBuffer[flxLoRaWANDownlink::kMaxPayload];
+    size_t _downlinkLen;
+    uint8_t _downlinkPort;
 
     char _devEUI[18];
 
     // for data transmission
     uint16_t _currentOffset; // offset into the current packet
     uint8_t _packetBuffer[kLoRaBufferLen];
+    uint8_t _dataPort; // port the packet buffer is sent on
 };
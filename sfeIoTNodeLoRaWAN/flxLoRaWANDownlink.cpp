@@ -0,0 +1,104 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxLoRaWANDownlink.h"
+
+//----------------------------------------------------------------
+// Add a handler to the table. A port/opcode can only have one handler - a new handler replaces the
+// existing one.
+
+bool flxLoRaWANDownlink::addHandler(uint8_t port, int16_t opcode, handler_t handler)
+{
+    if (port < kPortMin || port > kPortMax || !handler)
+        return false;
+
+    for (int i = 0; i < _nHandlers; i++)
+    {
+        if (_handlers[i].port == port && _handlers[i].opcode == opcode)
+        {
+            _handlers[i].handler = handler;
+            return true;
+        }
+    }
+
+    if (_nHandlers >= kMaxHandlers)
+        return false;
+
+    _handlers[_nHandlers].port = port;
+    _handlers[_nHandlers].opcode = opcode;
+    _handlers[_nHandlers].handler = handler;
+    _nHandlers++;
+
+    return true;
+}
+//----------------------------------------------------------------
+bool flxLoRaWANDownlink::setPortGate(uint8_t port, gate_t gate)
+{
+    if (port < kPortMin || port > kPortMax || !gate)
+        return false;
+
+    for (int i = 0; i < _nGates; i++)
+    {
+        if (_gates[i].port == port)
+        {
+            _gates[i].gate = gate;
+            return true;
+        }
+    }
+
+    if (_nGates >= kMaxGates)
+        return false;
+
+    _gates[_nGates].port = port;
+    _gates[_nGates].gate = gate;
+    _nGates++;
+
+    return true;
+}
+//----------------------------------------------------------------
+bool flxLoRaWANDownlink::dispatch(uint8_t port, const uint8_t *payload, size_t len)
+{
+    if (payload == nullptr || len == 0 || len > kMaxPayload)
+        return false;
+
+    handlerEntry_t *pHandler = nullptr;
+
+    for (int i = 0; i < _nHandlers; i++)
+    {
+        if (_handlers[i].port != port)
+            continue;
+
+        if (_handlers[i].opcode == payload[0])
+        {
+            pHandler = &_handlers[i];
+            break;
+        }
+        if (_handlers[i].opcode == kAnyOpcode)
+            pHandler = &_handlers[i];
+    }
+
+    if (!pHandler)
+        return false;
+
+    for (int i = 0; i < _nGates; i++)
+    {
+        if (_gates[i].port != port)
+            continue;
+
+        // the handler can run after the payload buffer is reused - so it gets a copy
+        handler_t handler = pHandler->handler;
+        std::vector<uint8_t> message(payload, payload + len);
+        _gates[i].gate([handler, port, message]() { handler(port, message.data(), message.size()); });
+        return true;
+    }
+
+    pHandler->handler(port, payload, len);
+    return true;
+}
@@ -0,0 +1,113 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Table driven dispatcher for LoRaWAN downlink messages.
+//
+// Handlers are registered for a port and opcode (the first byte of the payload), or for all messages
+// on a port. The handler is passed the full payload - including the opcode.
+//
+// A port can have a gate - for handlers that need something done first, like powering devices. The gate is
+// passed the handler call, and runs it when ready - which can be after dispatch returns.
+//
+// Portable - no Arduino or flux dependencies.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class flxLoRaWANDownlink
+{
+  public:
+    // Max downlink payload - the largest LoRaWAN application payload (US915/EU868)
+    static constexpr size_t kMaxPayload = 242;
+
+    // Max number of registered handlers
+    static constexpr uint8_t kMaxHandlers = 24;
+
+    // Max number of port gates
+    static constexpr uint8_t kMaxGates = 4;
+
+    // Valid application ports
+    static constexpr uint8_t kPortMin = 1;
+    static constexpr uint8_t kPortMax = 223;
+
+    typedef std::function<void(uint8_t port, const uint8_t *payload, size_t len)> handler_t;
+    typedef std::function<void(std::function<void(void)> handlerCall)> gate_t;
+
+    flxLoRaWANDownlink() : _nHandlers{0}, _nGates{0}
+    {
+    }
+
+    // Handler for an opcode on a port
+    bool registerHandler(uint8_t port, uint8_t opcode, handler_t handler)
+    {
+        return addHandler(port, opcode, handler);
+    }
+
+    template <typename T>
+    bool registerHandler(uint8_t port, uint8_t opcode, T *obj, void (T::*method)(uint8_t, const uint8_t *, size_t))
+    {
+        return addHandler(port, opcode, [=](uint8_t thePort, const uint8_t *payload, size_t len) {
+            (obj->*method)(thePort, payload, len);
+        });
+    }
+
+    // Handler for all messages on a port - an opcode handler on the same port has priority
+    bool registerPortHandler(uint8_t port, handler_t handler)
+    {
+        return addHandler(port, kAnyOpcode, handler);
+    }
+
+    template <typename T>
+    bool registerPortHandler(uint8_t port, T *obj, void (T::*method)(uint8_t, const uint8_t *, size_t))
+    {
+        return addHandler(port, kAnyOpcode, [=](uint8_t thePort, const uint8_t *payload, size_t len) {
+            (obj->*method)(thePort, payload, len);
+        });
+    }
+
+    // Gate for the handlers on a port - a new gate replaces the existing one
+    bool setPortGate(uint8_t port, gate_t gate);
+
+    // Dispatch a message - returns false if no handler took it
+    bool dispatch(uint8_t port, const uint8_t *payload, size_t len);
+
+    uint8_t nHandlers(void)
+    {
+        return _nHandlers;
+    }
+
+  private:
+    static constexpr int16_t kAnyOpcode = -1;
+
+    bool addHandler(uint8_t port, int16_t opcode, handler_t handler);
+
+    typedef struct
+    {
+        uint8_t port;
+        int16_t opcode;
+        handler_t handler;
+    } handlerEntry_t;
+
+    handlerEntry_t _handlers[kMaxHandlers];
+    uint8_t _nHandlers;
+
+    typedef struct
+    {
+        uint8_t port;
+        gate_t gate;
+    } gateEntry_t;
+
+    gateEntry_t _gates[kMaxGates];
+    uint8_t _nGates;
+};
@@ -0,0 +1,327 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxLoRaWANFirmwareUpdate.h"
+
+#include <LittleFS.h>
+#include <PicoOTA.h>
+
+#include <cstring>
+
+// The file the image is received into - on the on-board filesystem
+#define kFirmwareUpdateFile "/lorawan_fw.bin"
+
+// Time from sending the completion message to installing the image (ms)
+const uint32_t kFirmwareApplyDelay = 10000;
+
+// Image verification - bytes hashed per job run, and the time between runs (ms)
+const uint32_t kFirmwareVerifyChunk = 4096;
+const uint32_t kFirmwareVerifyPeriod = 20;
+
+// Sizes of the setup and fragment message headers - after the opcode
+const size_t kSessionSetupLen = 8 + flxSHA256::kDigestSize;
+const size_t kFragmentHeaderLen = 2;
+
+//----------------------------------------------------------------
+// Fragment store - a file on the on-board filesystem
+//
+class flxLoRaWANFileStore : public flxLoRaWANFragStore
+{
+  public:
+    bool open(const char *filename)
+    {
+        close();
+        _theFile = LittleFS.open(filename, "w+");
+        return (bool)_theFile;
+    }
+    void close(void)
+    {
+        if (_theFile)
+            _theFile.close();
+    }
+    bool writeAt(uint32_t offset, const uint8_t *data, size_t len)
+    {
+        return _theFile && _theFile.seek(offset) && _theFile.write(data, len) == len;
+    }
+    bool readAt(uint32_t offset, uint8_t *data, size_t len)
+    {
+        return _theFile && _theFile.seek(offset) && _theFile.read(data, len) == len;
+    }
+
+  private:
+    File _theFile;
+};
+
+static flxLoRaWANFileStore _fileStore;
+
+static uint32_t unpackUInt(const uint8_t *buffer, size_t len)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < len; i++)
+        value = (value << 8) | buffer[i];
+    return value;
+}
+
+//----------------------------------------------------------------
+flxLoRaWANFirmwareUpdate::flxLoRaWANFirmwareUpdate()
+    : _pLoRaWAN{nullptr}, _imageSize{0}, _imageDigest{0}, _verifyOffset{0}
+{
+    setName("LoRaWAN Firmware Update", "Firmware updates sent via the LoRaWAN network");
+
+    flxRegister(enabled, "Enabled", "Allow firmware updates via the LoRaWAN network");
+
+    flux_add(this);
+}
+//----------------------------------------------------------------
+bool flxLoRaWANFirmwareUpdate::setLoRaWAN(flxLoRaWANDigi *pLoRaWAN)
+{
+    if (pLoRaWAN == nullptr)
+        return false;
+
+    _pLoRaWAN = pLoRaWAN;
+
+    _verifyJob.setup("Firmware Verify", kFirmwareVerifyPeriod, this, &flxLoRaWANFirmwareUpdate::verifyImageCB);
+    _applyJob.setup("Firmware Update", kFirmwareApplyDelay, this, &flxLoRaWANFirmwareUpdate::applyUpdateCB, false);
+
+    return _pLoRaWAN->downlink().registerPortHandler(kLoRaWANFirmwareUpdatePort, this,
+                                                     &flxLoRaWANFirmwareUpdate::onDownlink);
+}
+//----------------------------------------------------------------
+void flxLoRaWANFirmwareUpdate::onDownlink(uint8_t /* port */, const uint8_t *payload, size_t len)
+{
+    if (payload == nullptr || len == 0)
+        return;
+
+    if (!enabled())
+    {
+        // fragments are dropped quietly - the rest get an answer
+        if (payload[0] != kOpFragment)
+            sendStatus(payload[0], kStatusDisabled);
+        return;
+    }
+
+    switch (payload[0])
+    {
+    case kOpSessionStatus:
+        sendSessionStatus();
+        break;
+
+    case kOpSessionSetup:
+        sessionSetup(payload + 1, len - 1);
+        break;
+
+    case kOpSessionDelete:
+        sessionDelete();
+        sendStatus(kOpSessionDelete, kStatusOK);
+        break;
+
+    case kOpFragment:
+        addFragment(payload + 1, len - 1);
+        break;
+
+    default:
+        flxLog_W(F("Firmware Update: Unknown opcode 0x%02X"), payload[0]);
+        break;
+    }
+}
+//----------------------------------------------------------------
+void flxLoRaWANFirmwareUpdate::sessionSetup(const uint8_t *payload, size_t len)
+{
+    sessionDelete();
+
+    if (len < kSessionSetupLen)
+    {
+        sendStatus(kOpSessionSetup, kStatusBadParams);
+        return;
+    }
+
+    uint16_t nFragments = unpackUInt(payload, 2);
+    uint8_t fragSize = payload[2];
+    uint8_t nParity = payload[3];
+    _imageSize = unpackUInt(payload + 4, 4);
+    memcpy(_imageDigest, payload + 8, sizeof(_imageDigest));
+
+    // does the image fit in the fragments?
+    if (_imageSize == 0 || _imageSize > (uint32_t)nFragments * fragSize)
+    {
+        sendStatus(kOpSessionSetup, kStatusBadParams);
+        return;
+    }
+
+    // Space for the data and parity fragments?
+    FSInfo fs_info;
+    uint32_t storeSize = flxLoRaWANFragDecoder::storeSize(nFragments, fragSize, nParity);
+    if (!LittleFS.info(fs_info) || fs_info.totalBytes - fs_info.usedBytes < storeSize)
+    {
+        flxLog_W(F("Firmware Update: Not enough space for a %u byte update"), storeSize);
+        sendStatus(kOpSessionSetup, kStatusNoSpace);
+        return;
+    }
+
+    if (!_fileStore.open(kFirmwareUpdateFile))
+    {
+        sendStatus(kOpSessionSetup, kStatusStorageError);
+        return;
+    }
+
+    if (!_decoder.begin(&_fileStore, nFragments, fragSize, nParity))
+    {
+        sessionDelete();
+        sendStatus(kOpSessionSetup, kStatusBadParams);
+        return;
+    }
+
+    flxLog_I(F("Firmware Update: Receiving a %u byte image - %u fragments, %u parity"), _imageSize, nFragments,
+             nParity);
+    sendStatus(kOpSessionSetup, kStatusOK);
+}
+//----------------------------------------------------------------
+void flxLoRaWANFirmwareUpdate::sessionDelete(void)
+{
+    flxRemoveJobFromQueue(_verifyJob);
+    flxRemoveJobFromQueue(_applyJob);
+
+    _decoder.end();
+    _fileStore.close();
+
+    if (LittleFS.exists(kFirmwareUpdateFile))
+        LittleFS.remove(kFirmwareUpdateFile);
+}
+//----------------------------------------------------------------
+void flxLoRaWANFirmwareUpdate::addFragment(const uint8_t *payload, size_t len)
+{
+    // no session, or already complete? Nothing to do
+    if (!_decoder.active() || _decoder.isComplete() || len <= kFragmentHeaderLen)
+        return;
+
+    uint16_t index = unpackUInt(payload, kFragmentHeaderLen);
+
+    flxLoRaWANFragDecoder::fragResult_t result =
+        _decoder.addFragment(index, payload + kFragmentHeaderLen, len - kFragmentHeaderLen);
+
+    if (result == flxLoRaWANFragDecoder::kFragInvalid)
+        flxLog_D(F("Firmware Update: Invalid fragment %u"), index);
+    else if (result == flxLoRaWANFragDecoder::kFragStoreError)
+        flxLog_E(F("Firmware Update: Error writing fragment %u"), index);
+
+    if (_decoder.isComplete())
+        sessionComplete();
+}
+//----------------------------------------------------------------
+// All fragments are in - start verifying the image. Hashing the whole image takes a while, so it's done
+// a piece at a time by the verify job.
+//
+void flxLoRaWANFirmwareUpdate::sessionComplete(void)
+{
+    flxLog_I(F("Firmware Update: Image received - %u fragments recovered. Verifying the image..."),
+             _decoder.nRecovered());
+
+    _verifyDigest.begin();
+    _verifyOffset = 0;
+    flxAddJobToQueue(_verifyJob);
+}
+//----------------------------------------------------------------
+// Hash the next piece of the image - once all of it is hashed, check the digest, and if valid, install
+// the image
+//
+void flxLoRaWANFirmwareUpdate::verifyImageCB(void)
+{
+    uint8_t buffer[256];
+
+    uint32_t endOffset = _imageSize - _verifyOffset > kFirmwareVerifyChunk ? _verifyOffset + kFirmwareVerifyChunk
+                                                                           : _imageSize;
+    while (_verifyOffset < endOffset)
+    {
+        size_t nRead = endOffset - _verifyOffset < sizeof(buffer) ? endOffset - _verifyOffset : sizeof(buffer);
+        if (!_fileStore.readAt(_verifyOffset, buffer, nRead))
+        {
+            flxLog_E(F("Firmware Update: Error reading the image"));
+            sessionDelete();
+            sendStatus(kOpSessionComplete, kStatusStorageError);
+            return;
+        }
+        _verifyDigest.update(buffer, nRead);
+        _verifyOffset += nRead;
+    }
+
+    // more to do?
+    if (_verifyOffset < _imageSize)
+        return;
+
+    flxRemoveJobFromQueue(_verifyJob);
+
+    uint8_t digest[flxSHA256::kDigestSize];
+    _verifyDigest.finish(digest);
+
+    if (memcmp(digest, _imageDigest, sizeof(digest)) != 0)
+    {
+        flxLog_E(F("Firmware Update: Image SHA-256 digest doesn't match - the image is discarded"));
+        sessionDelete();
+        sendStatus(kOpSessionComplete, kStatusVerifyError);
+        return;
+    }
+
+    flxLog_I(F("Firmware Update: Image verified. Installing in %u secs"), kFirmwareApplyDelay / 1000);
+
+    _fileStore.close();
+    sendStatus(kOpSessionComplete, kStatusOK);
+
+    flxAddJobToQueue(_applyJob);
+}
+//----------------------------------------------------------------
+// Hand the image to the OTA loader - it's installed by the boot loader on restart
+//
+void flxLoRaWANFirmwareUpdate::applyUpdateCB(void)
+{
+    flxLog_I(F("Firmware Update: Installing the new firmware and restarting..."));
+
+    picoOTA.begin();
+    if (!picoOTA.addFile(kFirmwareUpdateFile, 0, 0, _imageSize) || !picoOTA.commit())
+    {
+        flxLog_E(F("Firmware Update: Unable to install the firmware image"));
+        _decoder.end();
+        LittleFS.remove(kFirmwareUpdateFile);
+        return;
+    }
+    // last chance for the app to save data
+    flxSendEvent(flxEvent::kLoRaWANFirmwareInstall);
+
+    LittleFS.end();
+    delay(500);
+    rp2040.reboot();
+}
+//----------------------------------------------------------------
+void flxLoRaWANFirmwareUpdate::sendStatus(uint8_t opcode, uint8_t status)
+{
+    uint8_t message[2] = {opcode, status};
+
+    if (_pLoRaWAN == nullptr || !_pLoRaWAN->sendMessage(kLoRaWANFirmwareUpdatePort, message, sizeof(message)))
+        flxLog_D(F("Firmware Update: Unable to send status"));
+}
+//----------------------------------------------------------------
+void flxLoRaWANFirmwareUpdate::sendSessionStatus(void)
+{
+    if (!_decoder.active())
+    {
+        sendStatus(kOpSessionStatus, kStatusNoSession);
+        return;
+    }
+
+    uint16_t nReceived = _decoder.nFragments() - _decoder.nMissing();
+    uint8_t message[6] = {kOpSessionStatus,
+                          (uint8_t)(nReceived >> 8),
+                          (uint8_t)(nReceived & 0xFF),
+                          (uint8_t)(_decoder.nMissing() >> 8),
+                          (uint8_t)(_decoder.nMissing() & 0xFF),
+                          kStatusOK};
+
+    if (_pLoRaWAN == nullptr || !_pLoRaWAN->sendMessage(kLoRaWANFirmwareUpdatePort, message, sizeof(message)))
+        flxLog_D(F("Firmware Update: Unable to send status"));
+}
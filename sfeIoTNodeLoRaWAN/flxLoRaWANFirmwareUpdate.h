@@ -0,0 +1,112 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Firmware update over LoRaWAN - a firmware image is sent as fragments via downlinks on port 6.
+//
+// Fragments are written to a file on the on-board filesystem as they arrive, with lost fragments
+// recovered using parity fragments (see flxLoRaWANFragDecoder). Once complete, the SHA-256 digest of the
+// image is verified - a piece per job run, so other jobs keep running - and the image is handed to the
+// RP2350 OTA loader, which installs it on restart.
+//
+// Note: this is not the LoRa Alliance fragmentation protocol (TS004), so it doesn't use that port (201).
+//
+// Downlink messages:
+//      0x01                                            - session status request
+//      0x02 <nFrag:2> <fragSize:1> <nParity:1> <imageSize:4> <sha256:32> - session setup
+//      0x03                                            - session delete
+//      0x08 <index:2> <fragment>                       - data (index < nFrag) or parity fragment
+//
+// Uplink responses (same port) - the request opcode then:
+//      0x01 <received:2> <missing:2> <status:1>
+//      0x02 <status:1>
+//      0x03 <status:1>
+//      0x04 <status:1>                                 - sent when the image is complete and verified
+//
+// Values are big endian.
+
+#include "flxLoRaWANDigi.h"
+#include "flxLoRaWANFragDecoder.h"
+#include "flxSHA256.h"
+#include <Flux/flxCore.h>
+#include <Flux/flxCoreJobs.h>
+
+// The LoRaWAN port for firmware update messages
+const uint8_t kLoRaWANFirmwareUpdatePort = 6;
+
+// Event sent just before the device restarts to install a new firmware image
+flxDefineEventID(kLoRaWANFirmwareInstall);
+
+class flxLoRaWANFirmwareUpdate : public flxActionType<flxLoRaWANFirmwareUpdate>
+{
+  public:
+    // Message opcodes
+    static constexpr uint8_t kOpSessionStatus = 0x01;
+    static constexpr uint8_t kOpSessionSetup = 0x02;
+    static constexpr uint8_t kOpSessionDelete = 0x03;
+    static constexpr uint8_t kOpSessionComplete = 0x04;
+    static constexpr uint8_t kOpFragment = 0x08;
+
+    // Status codes
+    static constexpr uint8_t kStatusOK = 0x00;
+    static constexpr uint8_t kStatusDisabled = 0x01;
+    static constexpr uint8_t kStatusBadParams = 0x02;
+    static constexpr uint8_t kStatusNoSpace = 0x03;
+    static constexpr uint8_t kStatusStorageError = 0x04;
+    static constexpr uint8_t kStatusNoSession = 0x05;
+    static constexpr uint8_t kStatusVerifyError = 0x06;
+
+    flxLoRaWANFirmwareUpdate();
+
+    // Connect to the LoRaWAN connection - registers the downlink handler
+    bool setLoRaWAN(flxLoRaWANDigi *pLoRaWAN);
+
+    // Downlink handler - internal
+    void onDownlink(uint8_t port, const uint8_t *payload, size_t len);
+
+    bool sessionActive(void)
+    {
+        return _decoder.active();
+    }
+    const flxLoRaWANFragDecoder &decoder(void)
+    {
+        return _decoder;
+    }
+
+    // Allow firmware updates via LoRaWAN - off by default
+    flxPropertyBool<flxLoRaWANFirmwareUpdate> enabled = {false};
+
+  private:
+    void sessionSetup(const uint8_t *payload, size_t len);
+    void sessionDelete(void);
+    void addFragment(const uint8_t *payload, size_t len);
+    void sessionComplete(void);
+    void verifyImageCB(void);
+    void sendStatus(uint8_t opcode, uint8_t status);
+    void sendSessionStatus(void);
+    void applyUpdateCB(void);
+
+    flxLoRaWANDigi *_pLoRaWAN;
+
+    flxLoRaWANFragDecoder _decoder;
+
+    // image being received
+    uint32_t _imageSize;
+    uint8_t _imageDigest[flxSHA256::kDigestSize];
+
+    // verifies the received image - a piece each run
+    flxJob _verifyJob;
+    flxSHA256 _verifyDigest;
+    uint32_t _verifyOffset;
+
+    // installs the image - after the completion message is sent
+    flxJob _applyJob;
+};
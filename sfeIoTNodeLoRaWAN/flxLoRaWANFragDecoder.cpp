@@ -0,0 +1,127 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxLoRaWANFragDecoder.h"
+
+#include <cstring>
+
+//----------------------------------------------------------------
+bool flxLoRaWANFragDecoder::begin(flxLoRaWANFragStore *pStore, uint16_t nFragments, uint8_t fragSize,
+                                  uint8_t nParity)
+{
+    end();
+
+    if (pStore == nullptr || nFragments == 0 || nFragments > kMaxFragments || fragSize == 0 ||
+        fragSize > kMaxFragSize)
+        return false;
+
+    // every fragment - data and parity - needs an index
+    if ((uint32_t)nFragments + nParity > 0xFFFF)
+        return false;
+
+    _pStore = pStore;
+    _nFragments = nFragments;
+    _fragSize = fragSize;
+    _nParity = nParity;
+    _nMissing = nFragments;
+    _nRecovered = 0;
+
+    _received.assign(((uint32_t)nFragments + nParity + 7) / 8, 0);
+    _groupMissing.assign(nParity, 0);
+    for (uint16_t i = 0; nParity > 0 && i < nFragments; i++)
+        _groupMissing[i % nParity]++;
+
+    return true;
+}
+//----------------------------------------------------------------
+void flxLoRaWANFragDecoder::end(void)
+{
+    _pStore = nullptr;
+    _received.clear();
+    _received.shrink_to_fit();
+    _groupMissing.clear();
+    _groupMissing.shrink_to_fit();
+}
+//----------------------------------------------------------------
+flxLoRaWANFragDecoder::fragResult_t flxLoRaWANFragDecoder::addFragment(uint16_t index, const uint8_t *data,
+                                                                       size_t len)
+{
+    if (!active() || data == nullptr || len != _fragSize || (uint32_t)index >= (uint32_t)_nFragments + _nParity)
+        return kFragInvalid;
+
+    if (received(index))
+        return kFragDuplicate;
+
+    if (!_pStore->writeAt((uint32_t)index * _fragSize, data, len))
+        return kFragStoreError;
+
+    setReceived(index);
+
+    // data or parity?
+    uint8_t group;
+    if (index < _nFragments)
+    {
+        _nMissing--;
+        if (_nParity == 0)
+            return kFragAdded;
+
+        group = index % _nParity;
+        _groupMissing[group]--;
+    }
+    else
+        group = index - _nFragments;
+
+    // Can the group be recovered now?
+    if (_groupMissing[group] == 1 && received((uint32_t)_nFragments + group))
+    {
+        if (!recoverGroup(group))
+            return kFragStoreError;
+    }
+    return kFragAdded;
+}
+//----------------------------------------------------------------
+// Recover the one missing data fragment of a group - the XOR of the group parity and the received
+// data fragments of the group
+//
+bool flxLoRaWANFragDecoder::recoverGroup(uint8_t group)
+{
+    uint8_t result[kMaxFragSize];
+    uint8_t buffer[kMaxFragSize];
+
+    if (!_pStore->readAt(((uint32_t)_nFragments + group) * _fragSize, result, _fragSize))
+        return false;
+
+    uint16_t missing = _nFragments;
+    for (uint32_t i = group; i < _nFragments; i += _nParity)
+    {
+        if (!received(i))
+        {
+            missing = i;
+            continue;
+        }
+        if (!_pStore->readAt(i * _fragSize, buffer, _fragSize))
+            return false;
+
+        for (int j = 0; j < _fragSize; j++)
+            result[j] ^= buffer[j];
+    }
+    if (missing == _nFragments)
+        return true;
+
+    if (!_pStore->writeAt((uint32_t)missing * _fragSize, result, _fragSize))
+        return false;
+
+    setReceived(missing);
+    _groupMissing[group]--;
+    _nMissing--;
+    _nRecovered++;
+
+    return true;
+}
@@ -0,0 +1,131 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Fragmented data block reassembly with forward error correction - for firmware updates over LoRaWAN.
+//
+// A block is sent as nFragments data fragments, followed by nParity parity fragments. Data fragment i
+// is in parity group (i % nParity) and parity fragment g is the XOR of the data fragments in group g.
+// A group missing one data fragment is recovered once its parity fragment is received - since the
+// groups are interleaved, a burst of up to nParity lost fragments is recovered.
+//
+// Fragments are written to a store - a file on the board - at (index * fragSize), with the parity
+// fragments after the data. Only a received bitmap and the group counts are kept in memory.
+//
+// Portable - no Arduino or flux dependencies, so reassembly/recovery can be run on the host.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Storage for the fragments - random access reads and writes
+class flxLoRaWANFragStore
+{
+  public:
+    virtual ~flxLoRaWANFragStore()
+    {
+    }
+    virtual bool writeAt(uint32_t offset, const uint8_t *data, size_t len) = 0;
+    virtual bool readAt(uint32_t offset, uint8_t *data, size_t len) = 0;
+};
+
+class flxLoRaWANFragDecoder
+{
+  public:
+    // Fragment size limit - the largest LoRaWAN downlink payload, less the message header
+    static constexpr size_t kMaxFragSize = 232;
+
+    // Max number of fragments/parity fragments. Fragment indexes are 16 bits, so the data and parity
+    // fragments together can't be more than 0xFFFF.
+    static constexpr uint16_t kMaxFragments = 0xFFF0;
+    static constexpr uint8_t kMaxParity = 255;
+
+    // Results for adding a fragment
+    typedef enum
+    {
+        kFragAdded = 0,
+        kFragDuplicate,
+        kFragInvalid,
+        kFragStoreError
+    } fragResult_t;
+
+    flxLoRaWANFragDecoder() : _pStore{nullptr}, _nFragments{0}, _fragSize{0}, _nParity{0}, _nMissing{0}, _nRecovered{0}
+    {
+    }
+
+    // Start a block - returns false if the parameters are not valid
+    bool begin(flxLoRaWANFragStore *pStore, uint16_t nFragments, uint8_t fragSize, uint8_t nParity);
+    void end(void);
+
+    bool active(void) const
+    {
+        return _pStore != nullptr;
+    }
+
+    // Add a fragment - index < nFragments is data, nFragments + g is the parity for group g
+    fragResult_t addFragment(uint16_t index, const uint8_t *data, size_t len);
+
+    // All data fragments received or recovered?
+    bool isComplete(void) const
+    {
+        return active() && _nMissing == 0;
+    }
+
+    uint16_t nFragments(void) const
+    {
+        return _nFragments;
+    }
+    uint8_t fragSize(void) const
+    {
+        return _fragSize;
+    }
+    uint8_t nParity(void) const
+    {
+        return _nParity;
+    }
+    uint16_t nMissing(void) const
+    {
+        return _nMissing;
+    }
+    uint16_t nRecovered(void) const
+    {
+        return _nRecovered;
+    }
+
+    // The size of the store used - data and parity fragments
+    static uint32_t storeSize(uint16_t nFragments, uint8_t fragSize, uint8_t nParity)
+    {
+        return ((uint32_t)nFragments + nParity) * fragSize;
+    }
+
+  private:
+    bool received(uint32_t index) const
+    {
+        return (_received[index >> 3] & (1 << (index & 7))) != 0;
+    }
+    void setReceived(uint32_t index)
+    {
+        _received[index >> 3] |= (1 << (index & 7));
+    }
+
+    bool recoverGroup(uint8_t group);
+
+    flxLoRaWANFragStore *_pStore;
+    uint16_t _nFragments;
+    uint8_t _fragSize;
+    uint8_t _nParity;
+    uint16_t _nMissing;
+    uint16_t _nRecovered;
+
+    // received bitmap - data then parity fragments. Missing data fragments in each group.
+    std::vector<uint8_t> _received;
+    std::vector<uint16_t> _groupMissing;
+};
@@ -0,0 +1,177 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxLoRaWANLinkStats.h"
+
+#include <cstring>
+
+// EWMA weight of a new sample
+const float kLinkStatsAlpha = 0.125f;
+
+// Version of the packed health payload
+const uint8_t kLinkHealthVersion = 1;
+
+// LoRaWAN frame bytes added to the application payload - MHDR, DevAddr, FCtrl, FCnt, FPort and MIC
+const size_t kLoRaWANFrameOverhead = 13;
+const uint8_t kLoRaPreambleSymbols = 8;
+
+//----------------------------------------------------------------
+static float ewma(float average, float value, uint32_t nSamples)
+{
+    // first sample sets the average
+    return nSamples == 0 ? value : average + kLinkStatsAlpha * (value - average);
+}
+
+static uint8_t histogramBin(int16_t value, int16_t start, int16_t width, uint8_t nBins)
+{
+    if (value < start)
+        return 0;
+
+    int16_t bin = (value - start) / width;
+    return bin >= nBins ? nBins - 1 : bin;
+}
+//----------------------------------------------------------------
+void flxLoRaWANLinkStats::reset(void)
+{
+    _rssiAvg = 0.;
+    _snrAvg = 0.;
+    _txSuccessAvg = 0.;
+
+    _nSignal = 0;
+    _nTx = 0;
+    _nTxFailed = 0;
+    _txFailRun = 0;
+    _txFailRunMax = 0;
+    _lastTxStatus = 0;
+    _txAirtimeUS = 0;
+
+    _nDownlinks = 0;
+    _downlinkCounter = 0;
+    _lastDownlinkMS = 0;
+
+    memset(_rssiHist, 0, sizeof(_rssiHist));
+    memset(_snrHist, 0, sizeof(_snrHist));
+}
+//----------------------------------------------------------------
+void flxLoRaWANLinkStats::recordTx(uint8_t status, bool bSuccess)
+{
+    _txSuccessAvg = ewma(_txSuccessAvg, bSuccess ? 1.f : 0.f, _nTx);
+    _nTx++;
+    _lastTxStatus = status;
+
+    if (bSuccess)
+    {
+        _txFailRun = 0;
+        return;
+    }
+    _nTxFailed++;
+    _txFailRun++;
+    if (_txFailRun > _txFailRunMax)
+        _txFailRunMax = _txFailRun;
+}
+//----------------------------------------------------------------
+void flxLoRaWANLinkStats::recordSignal(int16_t rssi, int8_t snr)
+{
+    // no signal values reported?
+    if (rssi == 0 && snr == 0)
+        return;
+
+    _rssiAvg = ewma(_rssiAvg, rssi, _nSignal);
+    _snrAvg = ewma(_snrAvg, snr, _nSignal);
+    _nSignal++;
+
+    _rssiHist[histogramBin(rssi, kRSSIBinStart, kRSSIBinWidth, kRSSIBins)]++;
+    _snrHist[histogramBin(snr, kSNRBinStart, kSNRBinWidth, kSNRBins)]++;
+}
+//----------------------------------------------------------------
+void flxLoRaWANLinkStats::recordDownlink(uint32_t counter, uint32_t nowMS)
+{
+    _nDownlinks++;
+    _downlinkCounter = counter;
+
+    // 0 is no downlink
+    _lastDownlinkMS = nowMS == 0 ? 1 : nowMS;
+}
+//----------------------------------------------------------------
+uint32_t flxLoRaWANLinkStats::timeSinceDownlink(uint32_t nowMS) const
+{
+    return _lastDownlinkMS == 0 ? 0xFFFFFFFF : nowMS - _lastDownlinkMS;
+}
+//----------------------------------------------------------------
+// Health payload - big endian:
+//
+//   [0]      version
+//   [1]      RSSI average (dBm, int8)
+//   [2]      SNR average (dB x 4, int8)
+//   [3]      transmit success rate (percent)
+//   [4-5]    transmits
+//   [6-7]    failed transmits
+//   [8]      most consecutive failed transmits (saturated at 255)
+//   [9-10]   minutes since the last downlink (0xFFFF if none or more)
+
+static int8_t clampInt8(float value)
+{
+    return value < -128.f ? -128 : (value > 127.f ? 127 : (int8_t)value);
+}
+
+size_t flxLoRaWANLinkStats::packHealth(uint8_t *buffer, size_t len, uint32_t nowMS) const
+{
+    if (!buffer || len < kHealthPayloadSize)
+        return 0;
+
+    uint16_t nTx = _nTx > 0xFFFF ? 0xFFFF : _nTx;
+    uint16_t nFailed = _nTxFailed > 0xFFFF ? 0xFFFF : _nTxFailed;
+
+    uint32_t sinceDownlink = timeSinceDownlink(nowMS);
+    uint16_t minsDownlink = sinceDownlink == 0xFFFFFFFF || sinceDownlink / 60000 > 0xFFFF ? 0xFFFF
+                                                                                           : sinceDownlink / 60000;
+
+    buffer[0] = kLinkHealthVersion;
+    buffer[1] = (uint8_t)clampInt8(_rssiAvg);
+    buffer[2] = (uint8_t)clampInt8(_snrAvg * 4.f);
+    buffer[3] = (uint8_t)(_txSuccessAvg * 100.f + 0.5f);
+    buffer[4] = nTx >> 8;
+    buffer[5] = nTx & 0xFF;
+    buffer[6] = nFailed >> 8;
+    buffer[7] = nFailed & 0xFF;
+    buffer[8] = _txFailRunMax > 0xFF ? 0xFF : _txFailRunMax;
+    buffer[9] = minsDownlink >> 8;
+    buffer[10] = minsDownlink & 0xFF;
+
+    return kHealthPayloadSize;
+}
+//----------------------------------------------------------------
+void flxLoRaWANLinkStats::recordTxAirtime(size_t payloadLen, uint8_t spreadingFactor)
+{
+    _txAirtimeUS += airtime(payloadLen, spreadingFactor);
+}
+//----------------------------------------------------------------
+// The Semtech LoRa time on air calculation - 125 kHz bandwidth, coding rate 4/5, explicit header and CRC.
+// Low data rate optimization is used for SF11 and SF12.
+//
+uint32_t flxLoRaWANLinkStats::airtime(size_t payloadLen, uint8_t spreadingFactor)
+{
+    if (spreadingFactor < 7 || spreadingFactor > 12)
+        return 0;
+
+    // symbol time at 125 kHz - in us
+    uint32_t symbolUS = (1UL << spreadingFactor) * 8;
+
+    int32_t lowDR = spreadingFactor >= 11 ? 1 : 0;
+    int32_t bits = 8 * (int32_t)(payloadLen + kLoRaWANFrameOverhead) - 4 * spreadingFactor + 28 + 16;
+    int32_t divisor = 4 * (spreadingFactor - 2 * lowDR);
+
+    int32_t nPayloadSymbols = 8;
+    if (bits > 0)
+        nPayloadSymbols += ((bits + divisor - 1) / divisor) * 5;
+
+    // preamble is N + 4.25 symbols - in quarter symbols to stay in integers
+    return (4 * (kLoRaPreambleSymbols + nPayloadSymbols) + 17) * symbolUS / 4;
+}
@@ -0,0 +1,144 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Rolling LoRaWAN link quality statistics - fixed memory. Averages are EWMA, with RSSI/SNR histograms
+// for the distribution. Used to diagnose poorly placed nodes.
+//
+// Portable - no Arduino or flux dependencies. Time is passed in (ms).
+
+#include <cstddef>
+#include <cstdint>
+
+class flxLoRaWANLinkStats
+{
+  public:
+    // Histogram bins - RSSI in 10 dBm steps from -130, SNR in 5 dB steps from -20. The first and last
+    // bins include everything below/above.
+    static constexpr uint8_t kRSSIBins = 8;
+    static constexpr int16_t kRSSIBinStart = -130;
+    static constexpr int16_t kRSSIBinWidth = 10;
+
+    static constexpr uint8_t kSNRBins = 8;
+    static constexpr int8_t kSNRBinStart = -20;
+    static constexpr int8_t kSNRBinWidth = 5;
+
+    // size of the packed health payload - fits the smallest (US915 DR0) LoRaWAN payload
+    static constexpr size_t kHealthPayloadSize = 11;
+
+    flxLoRaWANLinkStats()
+    {
+        reset();
+    }
+
+    void reset(void);
+
+    // Record the status of a transmit, and the signal of a received packet
+    void recordTx(uint8_t status, bool bSuccess);
+    void recordSignal(int16_t rssi, int8_t snr);
+    void recordDownlink(uint32_t counter, uint32_t nowMS);
+
+    // Record the estimated time on air of an uplink - the application payload size and spreading factor
+    void recordTxAirtime(size_t payloadLen, uint8_t spreadingFactor);
+
+    // Estimated time on air of a LoRa uplink (125 kHz, CR 4/5) - in microseconds. The LoRaWAN frame
+    // overhead is added to the application payload size.
+    static uint32_t airtime(size_t payloadLen, uint8_t spreadingFactor);
+
+    // Averages - EWMA
+    float rssi(void) const
+    {
+        return _rssiAvg;
+    }
+    float snr(void) const
+    {
+        return _snrAvg;
+    }
+    // Transmit success rate - 0.0 to 1.0
+    float txSuccessRate(void) const
+    {
+        return _txSuccessAvg;
+    }
+
+    uint32_t nSignal(void) const
+    {
+        return _nSignal;
+    }
+    uint32_t nTx(void) const
+    {
+        return _nTx;
+    }
+    uint32_t nTxFailed(void) const
+    {
+        return _nTxFailed;
+    }
+    // Consecutive failed transmits - now, and the most seen
+    uint32_t txFailRun(void) const
+    {
+        return _txFailRun;
+    }
+    uint32_t txFailRunMax(void) const
+    {
+        return _txFailRunMax;
+    }
+    uint8_t lastTxStatus(void) const
+    {
+        return _lastTxStatus;
+    }
+    // Estimated total time on air of the uplinks - in ms
+    uint32_t txAirtime(void) const
+    {
+        return _txAirtimeUS / 1000;
+    }
+
+    uint32_t nDownlinks(void) const
+    {
+        return _nDownlinks;
+    }
+    uint32_t downlinkCounter(void) const
+    {
+        return _downlinkCounter;
+    }
+    // Time since the last downlink (ms) - 0xFFFFFFFF if none
+    uint32_t timeSinceDownlink(uint32_t nowMS) const;
+
+    uint32_t rssiHistogram(uint8_t bin) const
+    {
+        return bin < kRSSIBins ? _rssiHist[bin] : 0;
+    }
+    uint32_t snrHistogram(uint8_t bin) const
+    {
+        return bin < kSNRBins ? _snrHist[bin] : 0;
+    }
+
+    // Pack a compact health summary - returns the number of bytes used, 0 if the buffer is too small
+    size_t packHealth(uint8_t *buffer, size_t len, uint32_t nowMS) const;
+
+  private:
+    float _rssiAvg;
+    float _snrAvg;
+    float _txSuccessAvg;
+
+    uint32_t _nSignal;
+    uint32_t _nTx;
+    uint32_t _nTxFailed;
+    uint32_t _txFailRun;
+    uint32_t _txFailRunMax;
+    uint8_t _lastTxStatus;
+    uint64_t _txAirtimeUS;
+
+    uint32_t _nDownlinks;
+    uint32_t _downlinkCounter;
+    uint32_t _lastDownlinkMS;
+
+    uint32_t _rssiHist[kRSSIBins];
+    uint32_t _snrHist[kSNRBins];
+};
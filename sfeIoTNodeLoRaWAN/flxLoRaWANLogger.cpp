@@ -11,6 +11,8 @@
 #include "flxLoRaWANLogger.h"
 #include <Flux/flxDeviceValueTypes.h>
 
+#include <cstring>
+
 //---------------------------------------------------------------------------
 // flxLoRaWANLogger Class - outputs data to the lorawan during a log event
 //---------------------------------------------------------------------------
@@ -36,111 +38,196 @@ void flxLoRaWANLogger::logObservation(void)
 
     // loop over our devices
     for (auto pDevice : _devicesToLog)
-    {
-        // call execute if the device needs to do anything - like get the latest value
-        pDevice->execute();
+        logDevice(pDevice, kParamValueNone);
+
+    _pLoRaWAN->flushBuffer();
+}
+
+//----------------------------------------------------------------------------
+// Pack the values of a device - all values, or just those of the given value type. Returns the number
+// of values packed
+//
+uint16_t flxLoRaWANLogger::logDevice(flxDevice *pDevice, uint8_t valueType)
+{
+    uint16_t nValues = 0;
 
-        // flxLog_I("device: %s", pDevice->name());
+    // call execute if the device needs to do anything - like get the latest value
+    pDevice->execute();
 
+    // flxLog_I("device: %s", pDevice->name());
+
+    // now loop over the device's output parameters
+    for (auto param : pDevice->getOutputParameters())
+    {
+        // the send status of this parameter
         bool status = false;
-        // now loop over the device's output parameters
-        for (auto param : pDevice->getOutputParameters())
-        {
-            // Is this parameter enabled? Does it have a value Type set?
-            if (!param->enabled() || param->valueType() == kParamValueNone)
-                continue;
 
-            // we don't process arrays. We only process scalar values
-            if ((param->flags() & kParameterOutFlagArray) == kParameterOutFlagArray)
+        // Is this parameter enabled? Does it have a value Type set?
+        if (!param->enabled() || param->valueType() == kParamValueNone)
+            continue;
+
+        // Just a subset of values?
+        if (valueType != kParamValueNone && param->valueType() != valueType)
+            continue;
+
+        // we don't process arrays. We only process scalar values
+        if ((param->flags() & kParameterOutFlagArray) == kParameterOutFlagArray)
+        {
+            flxParameterOutArray *pArray = (flxParameterOutArray *)param->accessor();
+            // look for known values - if not, skip
+            switch (pArray->valueType())
             {
-                flxParameterOutArray *pArray = (flxParameterOutArray *)param->accessor();
-                // look for known values - if not, skip
-                switch (pArray->valueType())
+            case kParamValueLocation: {
+
+                flxDataArrayFloat *parrData = (flxDataArrayFloat *)pArray->get();
+
+                // is the data array sane?
+                if (parrData->size() != 2)
                 {
-                case kParamValueLocation: {
-
-                    flxDataArrayFloat *parrData = (flxDataArrayFloat *)pArray->get();
-
-                    // is the data array sane?
-                    if (parrData->size() != 2)
-                    {
-                        flxLog_W("Location array size is not 2. Size: %d", parrData->size());
-                        continue;
-                    }
-
-                    // location is a two element float array, that we want to send in the same packet.
-                    // So first, flush the buffer, then send the data
-                    _pLoRaWAN->flushBuffer();
-
-                    // trick the system into thinking we have a float array, which the LoRaWAN driver
-                    // can handle. We need to do this because the LoRaWAN driver is expecting a float array[2]
-                    float *pfData = parrData->get();
-                    float tmparr[2] = {pfData[0], pfData[1]};
-
-                    if (flxIsLoggingVerbose())
-                    {
-                        // dump out details for the parameter. Note - for packed value, this depends on
-                        // verbose output from the packer.
-                        flxLog_V_("LoRa Packing [%s::%s]  Type: Location  Value ID: 0x%02X Value: (%f,%f)",
-                                  pDevice->name(), param->name(), pArray->valueType(), tmparr[0], tmparr[1]);
-                    }
-
-                    // send the data
-                    status = _pLoRaWAN->sendData(pArray->valueType(), tmparr);
-                    break;
+                    flxLog_W("Location array size is not 2. Size: %d", parrData->size());
+                    continue;
                 }
-                default:
-                    flxLog_V("Array parameters not supported by LoRaWAN driver. Parameter: %s", param->name());
-                    break;
-                }
-                continue;
-            }
-            flxParameterOutScalar *pScalar = (flxParameterOutScalar *)param->accessor();
 
-            // key off type and make the call to the
+                // location is a two element float array, that we want to send in the same packet.
+                // So first, flush the buffer, then send the data
+                _pLoRaWAN->flushBuffer();
 
-            if (flxIsLoggingVerbose())
-            {
-                // dump out details for the parameter. Note - for packed value, this depends on
-                // verbose output from the packer.
-                flxLog_V_("LoRa Packing [%s::%s]  Type: %s  Value ID: 0x%02X Value: ", pDevice->name(), param->name(),
-                          flxGetTypeName(param->type()), pScalar->valueType());
-            }
-            // okay, we have a value type we know, lets process it and send it to the network
+                // trick the system into thinking we have a float array, which the LoRaWAN driver
+                // can handle. We need to do this because the LoRaWAN driver is expecting a float array[2]
+                float *pfData = parrData->get();
+                float tmparr[2] = {pfData[0], pfData[1]};
 
-            switch (param->type())
-            {
-            case flxTypeBool:
-                status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getBool());
-                break;
-            case flxTypeUInt8:
-                status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getUInt8());
-                break;
-            case flxTypeInt8:
-                status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getInt8());
-                break;
-            case flxTypeUInt16:
-                status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getUInt16());
-                break;
-            case flxTypeInt16:
-                status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getInt16());
-                break;
-            case flxTypeUInt32:
-                status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getUInt32());
-                break;
-            case flxTypeInt32:
-                status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getInt32());
-                break;
-            case flxTypeFloat:
-            case flxTypeDouble:
-                status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getFloat());
+                if (flxIsLoggingVerbose())
+                {
+                    // dump out details for the parameter. Note - for packed value, this depends on
+                    // verbose output from the packer.
+                    flxLog_V_("LoRa Packing [%s::%s]  Type: Location  Value ID: 0x%02X Value: (%f,%f)",
+                              pDevice->name(), param->name(), pArray->valueType(), tmparr[0], tmparr[1]);
+                }
+
+                // send the data
+                status = _pLoRaWAN->sendData(pArray->valueType(), tmparr);
                 break;
+            }
             default:
+                flxLog_V("Array parameters not supported by LoRaWAN driver. Parameter: %s", param->name());
                 break;
             }
-            if (!status)
-                flxLog_W(F("LoRaWAN send failed for parameter: %s"), pScalar->name());
+            if (status)
+                nValues++;
+            continue;
         }
+        flxParameterOutScalar *pScalar = (flxParameterOutScalar *)param->accessor();
+
+        // key off type and make the call to the
+
+        if (flxIsLoggingVerbose())
+        {
+            // dump out details for the parameter. Note - for packed value, this depends on
+            // verbose output from the packer.
+            flxLog_V_("LoRa Packing [%s::%s]  Type: %s  Value ID: 0x%02X Value: ", pDevice->name(), param->name(),
+                      flxGetTypeName(param->type()), pScalar->valueType());
+        }
+        // okay, we have a value type we know, lets process it and send it to the network
+
+        switch (param->type())
+        {
+        case flxTypeBool:
+            status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getBool());
+            break;
+        case flxTypeUInt8:
+            status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getUInt8());
+            break;
+        case flxTypeInt8:
+            status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getInt8());
+            break;
+        case flxTypeUInt16:
+            status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getUInt16());
+            break;
+        case flxTypeInt16:
+            status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getInt16());
+            break;
+        case flxTypeUInt32:
+            status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getUInt32());
+            break;
+        case flxTypeInt32:
+            status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getInt32());
+            break;
+        case flxTypeFloat:
+        case flxTypeDouble:
+            status = _pLoRaWAN->sendData(pScalar->valueType(), pScalar->getFloat());
+            break;
+        default:
+            break;
+        }
+        if (!status)
+            flxLog_W(F("LoRaWAN send failed for parameter: %s"), pScalar->name());
+        else
+            nValues++;
+    }
+    return nValues;
+}
+
+//----------------------------------------------------------------------------
+void flxLoRaWANLogger::setLoRaWAN(flxLoRaWANDigi *pLoRaWAN)
+{
+    _pLoRaWAN = pLoRaWAN;
+
+    if (_pLoRaWAN != nullptr)
+        _pLoRaWAN->downlink().registerPortHandler(kLoRaWANReadPort, this, &flxLoRaWANLogger::onReadRequest);
+}
+
+//----------------------------------------------------------------------------
+// Downlink read request - read the requested devices/values now, and send them on the read port
+//
+void flxLoRaWANLogger::onReadRequest(uint8_t /* port */, const uint8_t *payload, size_t len)
+{
+    if (!_pLoRaWAN || !_pLoRaWAN->isConnected() || payload == nullptr || len < 2)
+        return;
+
+    // The values go out on the read port - in the same encoding as logged data
+    _pLoRaWAN->setDataPort(kLoRaWANReadPort);
+
+    uint16_t nValues = 0;
+    uint8_t index = 0;
+
+    switch (payload[0])
+    {
+    case kReadOpDevice: {
+        // device by index, with an optional value type
+        uint8_t valueType = len > 2 ? payload[2] : kParamValueNone;
+        for (auto pDevice : _devicesToLog)
+        {
+            if (payload[1] == kReadAllDevices || payload[1] == index)
+                nValues += logDevice(pDevice, valueType);
+            index++;
+        }
+        break;
+    }
+    case kReadOpValueType:
+        for (auto pDevice : _devicesToLog)
+            nValues += logDevice(pDevice, payload[1]);
+        break;
+
+    case kReadOpDeviceName:
+        for (auto pDevice : _devicesToLog)
+        {
+            if (strlen(pDevice->name()) == len - 1 && strncmp(pDevice->name(), (const char *)payload + 1, len - 1) == 0)
+                nValues += logDevice(pDevice, kParamValueNone);
+        }
+        break;
+
+    default:
+        flxLog_W(F("LoRaWAN read request: Unknown opcode 0x%02X"), payload[0]);
+        break;
     }
     _pLoRaWAN->flushBuffer();
+    _pLoRaWAN->setDataPort(kLoRaWANDataPort);
+
+    // Nothing matched? Let the requester know
+    if (nValues == 0)
+    {
+        uint8_t noValues = kParamValueNone;
+        _pLoRaWAN->sendMessage(kLoRaWANReadPort, &noValues, sizeof(noValues));
+    }
 }
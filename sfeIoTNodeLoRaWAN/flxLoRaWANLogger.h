@@ -17,6 +17,9 @@
 #include "flxLoRaWANDigi.h"
 #include <Flux/flxCore.h>
 
+// The LoRaWAN port for read requests, and the values sent in response
+const uint8_t kLoRaWANReadPort = 5;
+
 // Define the Logging class
 class flxLoRaWANLogger : public flxActionType<flxLoRaWANLogger>
 {
@@ -85,9 +88,23 @@ class flxLoRaWANLogger : public flxActionType<flxLoRaWANLogger>
     {
         setLoRaWAN(&pLoRaWAN);
     }
-    void setLoRaWAN(flxLoRaWANDigi *pLoRaWAN)
+    void setLoRaWAN(flxLoRaWANDigi *pLoRaWAN);
+
+    // Read request opcodes - for downlinks on the read port
+    static constexpr uint8_t kReadOpDevice = 0x01;     // <device index> [<value type>]
+    static constexpr uint8_t kReadOpValueType = 0x02;  // <value type>
+    static constexpr uint8_t kReadOpDeviceName = 0x03; // <device name>
+
+    // Device index for all devices
+    static constexpr uint8_t kReadAllDevices = 0xFF;
+
+    // Downlink read request handler - internal
+    void onReadRequest(uint8_t port, const uint8_t *payload, size_t len);
+
+    // The devices logged - in read request index order
+    flxDeviceContainer &devices(void)
     {
-        _pLoRaWAN = pLoRaWAN;
+        return _devicesToLog;
     }
 
   private:
@@ -158,5 +175,8 @@ class flxLoRaWANLogger : public flxActionType<flxLoRaWANLogger>
     }
 
   private:
+    // pack the values of a device - all, or just one value type
+    uint16_t logDevice(flxDevice *pDevice, uint8_t valueType);
+
     flxLoRaWANDigi *_pLoRaWAN;
 };
@@ -0,0 +1,364 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxLoRaWANRemoteConfig.h"
+#include <Flux/flxSettings.h>
+
+#include <algorithm>
+#include <cstring>
+
+// Time between response uplinks (ms)
+const uint32_t kRemoteConfigResponseTime = 5000;
+
+// Size of a property ID in a message
+const size_t kRemoteConfigIDLen = 2;
+
+//----------------------------------------------------------------
+// Value encoding - the size of a value of the given type - 0 if not supported
+//
+static size_t valueSize(flxDataType_t type)
+{
+    switch (type)
+    {
+    case flxTypeBool:
+    case flxTypeInt8:
+    case flxTypeUInt8:
+        return 1;
+
+    case flxTypeInt16:
+    case flxTypeUInt16:
+        return 2;
+
+    case flxTypeInt32:
+    case flxTypeUInt32:
+    case flxTypeFloat:
+    case flxTypeDouble:
+        return 4;
+
+    default:
+        break;
+    }
+    return 0;
+}
+
+static void packUInt(uint32_t value, uint8_t *buffer, size_t len)
+{
+    for (int i = len - 1; i >= 0; i--, value >>= 8)
+        buffer[i] = value & 0xFF;
+}
+
+static uint32_t unpackUInt(const uint8_t *buffer, size_t len)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < len; i++)
+        value = (value << 8) | buffer[i];
+    return value;
+}
+
+// Pack a value - returns the number of bytes packed
+static size_t packValue(flxDataVariable &var, uint8_t *buffer)
+{
+    uint32_t bits;
+    float fValue;
+
+    switch (var.type)
+    {
+    case flxTypeBool:
+        buffer[0] = var.value.b ? 1 : 0;
+        break;
+    case flxTypeInt8:
+        buffer[0] = (uint8_t)var.value.i8;
+        break;
+    case flxTypeUInt8:
+        buffer[0] = var.value.ui8;
+        break;
+    case flxTypeInt16:
+        packUInt((uint16_t)var.value.i16, buffer, 2);
+        break;
+    case flxTypeUInt16:
+        packUInt(var.value.ui16, buffer, 2);
+        break;
+    case flxTypeInt32:
+        packUInt((uint32_t)var.value.i32, buffer, 4);
+        break;
+    case flxTypeUInt32:
+        packUInt(var.value.ui32, buffer, 4);
+        break;
+    case flxTypeFloat:
+    case flxTypeDouble:
+        fValue = var.type == flxTypeFloat ? var.value.f : (float)var.value.d;
+        memcpy(&bits, &fValue, sizeof(bits));
+        packUInt(bits, buffer, 4);
+        break;
+    default:
+        return 0;
+    }
+    return valueSize(var.type);
+}
+
+// Unpack a value of the given type
+static void unpackValue(flxDataType_t type, const uint8_t *buffer, flxDataVariable &var)
+{
+    uint32_t bits = unpackUInt(buffer, valueSize(type));
+    float fValue;
+
+    var.type = type;
+    switch (type)
+    {
+    case flxTypeBool:
+        var.value.b = bits != 0;
+        break;
+    case flxTypeInt8:
+        var.value.i8 = (int8_t)bits;
+        break;
+    case flxTypeUInt8:
+        var.value.ui8 = (uint8_t)bits;
+        break;
+    case flxTypeInt16:
+        var.value.i16 = (int16_t)bits;
+        break;
+    case flxTypeUInt16:
+        var.value.ui16 = (uint16_t)bits;
+        break;
+    case flxTypeInt32:
+        var.value.i32 = (int32_t)bits;
+        break;
+    case flxTypeUInt32:
+        var.value.ui32 = bits;
+        break;
+    case flxTypeFloat:
+    case flxTypeDouble:
+        memcpy(&fValue, &bits, sizeof(fValue));
+        if (type == flxTypeFloat)
+            var.value.f = fValue;
+        else
+            var.value.d = fValue;
+        break;
+    default:
+        break;
+    }
+}
+//----------------------------------------------------------------
+// FNV-1a over "<object>.<property>", folded to 16 bits
+//
+uint16_t flxLoRaWANRemoteConfig::propertyID(const char *objName, const char *propName)
+{
+    uint32_t hash = 2166136261u;
+
+    auto hashString = [&hash](const char *str) {
+        for (; str && *str; str++)
+        {
+            hash ^= (uint8_t)*str;
+            hash *= 16777619u;
+        }
+    };
+    hashString(objName);
+    hashString(".");
+    hashString(propName);
+
+    return (uint16_t)((hash >> 16) ^ (hash & 0xFFFF));
+}
+//----------------------------------------------------------------
+uint16_t flxLoRaWANRemoteConfig::add(flxObject *pObj)
+{
+    if (pObj == nullptr)
+        return 0;
+
+    uint16_t nAdded = 0;
+    for (auto prop : pObj->getProperties())
+    {
+        // Only numeric/bool values are supported - this also keeps strings and keys off the air
+        if (valueSize(prop->type()) == 0)
+            continue;
+
+        uint16_t id = propertyID(pObj->name(), prop->name());
+
+        propertyEntry_t *pEntry = findProperty(id);
+        if (pEntry != nullptr)
+        {
+            if (pEntry->property != prop)
+                flxLog_W(F("Remote Config: ID collision for %s.%s - not added"), pObj->name(), prop->name());
+            continue;
+        }
+        _properties.push_back({id, pObj, prop});
+        nAdded++;
+    }
+    return nAdded;
+}
+//----------------------------------------------------------------
+flxLoRaWANRemoteConfig::propertyEntry_t *flxLoRaWANRemoteConfig::findProperty(uint16_t id)
+{
+    for (auto &entry : _properties)
+    {
+        if (entry.id == id)
+            return &entry;
+    }
+    return nullptr;
+}
+//----------------------------------------------------------------
+bool flxLoRaWANRemoteConfig::setLoRaWAN(flxLoRaWANDigi *pLoRaWAN)
+{
+    if (pLoRaWAN == nullptr)
+        return false;
+
+    _pLoRaWAN = pLoRaWAN;
+
+    _responseJob.setup("Remote Config", kRemoteConfigResponseTime, this, &flxLoRaWANRemoteConfig::sendResponsesCB);
+
+    return _pLoRaWAN->downlink().registerPortHandler(kLoRaWANRemoteConfigPort, this,
+                                                     &flxLoRaWANRemoteConfig::onDownlink);
+}
+//----------------------------------------------------------------
+void flxLoRaWANRemoteConfig::onDownlink(uint8_t port, const uint8_t *payload, size_t len)
+{
+    if (payload == nullptr || len == 0)
+        return;
+
+    switch (payload[0])
+    {
+    case kOpGet:
+        getProperties(payload + 1, len - 1);
+        break;
+
+    case kOpSet:
+        setProperties(payload + 1, len - 1);
+        break;
+
+    default:
+        flxLog_W(F("Remote Config: Unknown opcode 0x%02X"), payload[0]);
+        return;
+    }
+
+    // Start sending the responses
+    if (_responses.size() > 0)
+        flxAddJobToQueue(_responseJob);
+}
+//----------------------------------------------------------------
+void flxLoRaWANRemoteConfig::getProperties(const uint8_t *payload, size_t len)
+{
+    // entry: id, status, value
+    uint8_t entry[kRemoteConfigIDLen + 1 + sizeof(uint32_t)];
+
+    for (size_t i = 0; i + kRemoteConfigIDLen <= len; i += kRemoteConfigIDLen)
+    {
+        uint16_t id = unpackUInt(payload + i, kRemoteConfigIDLen);
+        size_t entryLen = kRemoteConfigIDLen + 1;
+
+        packUInt(id, entry, kRemoteConfigIDLen);
+
+        propertyEntry_t *pEntry = findProperty(id);
+        if (pEntry == nullptr)
+            entry[kRemoteConfigIDLen] = kStatusUnknownID;
+        else
+        {
+            flxDataVariable value = pEntry->property->getValue();
+            size_t valueLen = packValue(value, entry + entryLen);
+            entry[kRemoteConfigIDLen] = valueLen > 0 ? kStatusOK : kStatusUnsupported;
+            entryLen += valueLen;
+        }
+        addResponse(kOpGet, entry, entryLen);
+    }
+}
+//----------------------------------------------------------------
+void flxLoRaWANRemoteConfig::setProperties(const uint8_t *payload, size_t len)
+{
+    // entry: id, status
+    uint8_t entry[kRemoteConfigIDLen + 1];
+    std::vector<flxObject *> changed;
+
+    size_t i = 0;
+    while (i + kRemoteConfigIDLen <= len)
+    {
+        uint16_t id = unpackUInt(payload + i, kRemoteConfigIDLen);
+        i += kRemoteConfigIDLen;
+
+        packUInt(id, entry, kRemoteConfigIDLen);
+
+        // Without the property, the value size isn't known - so the rest of the message is dropped
+        propertyEntry_t *pEntry = findProperty(id);
+        if (pEntry == nullptr)
+        {
+            entry[kRemoteConfigIDLen] = kStatusUnknownID;
+            addResponse(kOpSet, entry, sizeof(entry));
+            break;
+        }
+
+        flxDataType_t type = pEntry->property->type();
+        size_t valueLen = valueSize(type);
+        if (i + valueLen > len)
+        {
+            entry[kRemoteConfigIDLen] = kStatusBadLength;
+            addResponse(kOpSet, entry, sizeof(entry));
+            break;
+        }
+
+        flxDataVariable value;
+        unpackValue(type, payload + i, value);
+        i += valueLen;
+
+        if (pEntry->property->setValue(value))
+        {
+            entry[kRemoteConfigIDLen] = kStatusOK;
+            flxLog_I(F("Remote Config: %s.%s set to %s"), pEntry->object->name(), pEntry->property->name(),
+                     pEntry->property->to_string().c_str());
+
+            if (std::find(changed.begin(), changed.end(), pEntry->object) == changed.end())
+                changed.push_back(pEntry->object);
+        }
+        else
+            entry[kRemoteConfigIDLen] = kStatusSetFailed;
+
+        addResponse(kOpSet, entry, sizeof(entry));
+    }
+
+    // Persist the changes
+    for (auto pObj : changed)
+        flxSettings.save(pObj, true);
+}
+//----------------------------------------------------------------
+// Add an entry to the response messages - a new message is started when the current one is full
+//
+void flxLoRaWANRemoteConfig::addResponse(uint8_t opcode, const uint8_t *entry, size_t len)
+{
+    uint8_t respOpcode = opcode | kResponseFlag;
+
+    if (_responses.empty() || _responses.back()[0] != respOpcode ||
+        _responses.back().size() + len > kResponseMaxLen)
+        _responses.push_back(std::vector<uint8_t>(1, respOpcode));
+
+    _responses.back().insert(_responses.back().end(), entry, entry + len);
+}
+//----------------------------------------------------------------
+// Send the next response message - runs until all are sent
+//
+void flxLoRaWANRemoteConfig::sendResponsesCB(void)
+{
+    if (_responses.empty())
+    {
+        flxRemoveJobFromQueue(_responseJob);
+        return;
+    }
+
+    // not connected - try later
+    if (_pLoRaWAN == nullptr || !_pLoRaWAN->isConnected())
+        return;
+
+    std::vector<uint8_t> &message = _responses.front();
+
+    if (!_pLoRaWAN->sendMessage(kLoRaWANRemoteConfigPort, message.data(), message.size()))
+    {
+        flxLog_D(F("Remote Config: Failed to send a response"));
+        return;
+    }
+    _responses.pop_front();
+
+    if (_responses.empty())
+        flxRemoveJobFromQueue(_responseJob);
+}
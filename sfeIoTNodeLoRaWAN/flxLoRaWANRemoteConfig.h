@@ -0,0 +1,107 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Remote configuration of flux properties via LoRaWAN downlinks.
+//
+// Properties are addressed by a 16 bit ID - a hash of "<object name>.<property name>" - so the ID of a
+// property is stable across builds and devices. Numeric and bool properties are supported.
+//
+// Downlink (on the remote config port):
+//      0x01 <id> [<id> ...]                    - get property values
+//      0x02 <id> <value> [<id> <value> ...]    - set property values. The value size is set by the
+//                                                property type
+//
+// Responses are sent as uplinks on the same port - split over several messages if needed:
+//      0x81 <id> <status> [<value>] ...        - get response. The value is sent if status is OK
+//      0x82 <id> <status> ...                  - set response
+//
+// Values are big endian - bool/int8/uint8: 1 byte, int16/uint16: 2 bytes, int32/uint32/float: 4 bytes.
+// Double values are sent as float.
+
+#include <deque>
+#include <vector>
+
+#include "flxLoRaWANDigi.h"
+#include <Flux/flxCore.h>
+#include <Flux/flxCoreJobs.h>
+
+// The LoRaWAN port for remote configuration messages
+const uint8_t kLoRaWANRemoteConfigPort = 4;
+
+class flxLoRaWANRemoteConfig
+{
+  public:
+    // Message opcodes - responses have the kResponseFlag bit set
+    static constexpr uint8_t kOpGet = 0x01;
+    static constexpr uint8_t kOpSet = 0x02;
+    static constexpr uint8_t kResponseFlag = 0x80;
+
+    // Status codes for each property in a response
+    static constexpr uint8_t kStatusOK = 0x00;
+    static constexpr uint8_t kStatusUnknownID = 0x01;
+    static constexpr uint8_t kStatusUnsupported = 0x02;
+    static constexpr uint8_t kStatusBadLength = 0x03;
+    static constexpr uint8_t kStatusSetFailed = 0x04;
+
+    typedef struct
+    {
+        uint16_t id;
+        flxObject *object;
+        flxProperty *property;
+    } propertyEntry_t;
+
+    flxLoRaWANRemoteConfig() : _pLoRaWAN{nullptr}
+    {
+    }
+
+    // Add the properties of an object - returns the number of properties added
+    uint16_t add(flxObject *pObj);
+    uint16_t add(flxObject &obj)
+    {
+        return add(&obj);
+    }
+
+    // Connect to the LoRaWAN connection - registers the downlink handler
+    bool setLoRaWAN(flxLoRaWANDigi *pLoRaWAN);
+
+    // The ID for a property - a 16 bit (folded) FNV-1a hash of "<object>.<property>"
+    static uint16_t propertyID(const char *objName, const char *propName);
+
+    const std::vector<propertyEntry_t> &properties(void)
+    {
+        return _properties;
+    }
+
+    // Downlink handler - internal
+    void onDownlink(uint8_t port, const uint8_t *payload, size_t len);
+
+  private:
+    propertyEntry_t *findProperty(uint16_t id);
+
+    void getProperties(const uint8_t *payload, size_t len);
+    void setProperties(const uint8_t *payload, size_t len);
+
+    // Response building - values are queued in messages of up to kResponseMaxLen bytes
+    void addResponse(uint8_t opcode, const uint8_t *entry, size_t len);
+    void sendResponsesCB(void);
+
+    // Response message size - fits all regions/data rates
+    static constexpr size_t kResponseMaxLen = 11;
+
+    flxLoRaWANDigi *_pLoRaWAN;
+
+    std::vector<propertyEntry_t> _properties;
+
+    // Response messages waiting to be sent - one is sent each job period
+    std::deque<std::vector<uint8_t>> _responses;
+    flxJob _responseJob;
+};
@@ -0,0 +1,102 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Transport interface for the LoRaWAN connection - the modem operations used by flxLoRaWANDigi.
+//
+// Implementations:
+//      flxLoRaWANTransportXBee - the Digi XBee LR module (default)
+//      flxLoRaWANTransportSim  - a simulated modem, portable - builds on the host. Selected with the
+//                                build flag FLX_LORAWAN_SIMULATED_MODEM
+//
+// Note: no Arduino or flux dependencies in this header
+
+#include <cstddef>
+#include <cstdint>
+
+// Packet passed to the transport callbacks - for received packets and send completions
+typedef struct
+{
+    uint8_t *payload;
+    uint8_t payloadSize;
+    uint8_t port;
+    uint8_t ack;
+    int16_t rssi;
+    int8_t snr;
+    uint32_t counter;
+    uint8_t status;
+    uint8_t frameId;
+} flxLoRaWANPacket_t;
+
+// Transmit status codes - the XBee LR codes, used by all transports
+const uint8_t kLoRaWANTxStatusSuccess = 0x00;
+const uint8_t kLoRaWANTxStatusAckFailed = 0x01;
+const uint8_t kLoRaWANTxStatusNotConnected = 0x22;
+
+class flxLoRaWANTransport
+{
+  public:
+    typedef void (*packetCallback_t)(void *context, flxLoRaWANPacket_t *packet);
+
+    flxLoRaWANTransport() : _onReceive{nullptr}, _onSend{nullptr}, _cbContext{nullptr}
+    {
+    }
+
+    virtual ~flxLoRaWANTransport()
+    {
+    }
+
+    // Callbacks - received packets, and send completions. The context is passed to the callbacks
+    void setCallbacks(packetCallback_t onReceive, packetCallback_t onSend, void *context = nullptr)
+    {
+        _onReceive = onReceive;
+        _onSend = onSend;
+        _cbContext = context;
+    }
+
+    virtual const char *name(void) = 0;
+
+    // Start the modem. The UART rate is requested - uartRate() returns the rate in use (0 if not known)
+    virtual bool begin(uint32_t baudRate) = 0;
+    virtual void reset(void) = 0;
+    virtual uint32_t uartRate(void)
+    {
+        return 0;
+    }
+
+    // Configuration - the modem stores these values once written and applied
+    virtual bool getDevEUI(char *devEUI, size_t len) = 0;
+    virtual bool setRegion(uint8_t region) = 0;
+    virtual bool setChannelsMask(const char *mask) = 0;
+    virtual bool setAppEUI(const char *appEUI) = 0;
+    virtual bool setAppKey(const char *appKey) = 0;
+    virtual bool setNwkKey(const char *nwkKey) = 0;
+    virtual bool setApiOptions(uint8_t options) = 0;
+    virtual bool setClass(char loraClass) = 0;
+    virtual bool writeConfig(void) = 0;
+    virtual bool applyChanges(void) = 0;
+
+    // Network
+    virtual bool connect(void) = 0;
+    virtual bool disconnect(void) = 0;
+    virtual bool isConnected(void) = 0;
+
+    // Process modem messages - callbacks are called from this method
+    virtual void process(void) = 0;
+
+    // Send data - completion is reported to the send callback
+    virtual bool sendData(uint8_t port, const uint8_t *payload, size_t len, bool ack) = 0;
+
+  protected:
+    packetCallback_t _onReceive;
+    packetCallback_t _onSend;
+    void *_cbContext;
+};
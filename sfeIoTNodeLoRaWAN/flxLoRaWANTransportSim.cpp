@@ -0,0 +1,270 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxLoRaWANTransportSim.h"
+
+#include <cstring>
+#include <utility>
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+// Simulated airtime - roughly SF10/125kHz - base (preamble + header) and per payload byte (ms)
+const uint32_t kSimAirtimeBaseMS = 190;
+const uint32_t kSimAirtimeByteMS = 8;
+
+// The Device EUI reported by the simulated modem
+#define kSimDevEUI "0013A2FFFE5A1D00"
+
+//----------------------------------------------------------------
+// Default clock
+static uint32_t simDefaultClockMS(void)
+{
+#if defined(ARDUINO)
+    return millis();
+#else
+    static auto startTime = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                           startTime)
+        .count();
+#endif
+}
+//----------------------------------------------------------------
+flxLoRaWANTransportSim::flxLoRaWANTransportSim()
+    : _joinDelayMS{FLX_LORAWAN_SIM_JOIN_DELAY_MS}, _joinFailPercent{0}, _lossPercent{FLX_LORAWAN_SIM_LOSS_PERCENT},
+      _airtimeBaseMS{kSimAirtimeBaseMS}, _airtimeByteMS{kSimAirtimeByteMS}, _forcedStatus{kLoRaWANTxStatusSuccess},
+      _clockMS{simDefaultClockMS}, _onMonitor{nullptr}, _monitorContext{nullptr}, _started{false}, _joined{false},
+      _uartRate{0}, _loraClass{'A'}, _frameId{0}, _nJoins{0}, _nSent{0}, _nLost{0}, _totalAirtimeMS{0},
+      _downlinkCounter{0}
+{
+}
+//----------------------------------------------------------------
+bool flxLoRaWANTransportSim::chance(uint8_t percent)
+{
+    if (percent == 0)
+        return false;
+    return (_random() % 100) < percent;
+}
+
+void flxLoRaWANTransportSim::sleepMS(uint32_t ms)
+{
+#if defined(ARDUINO)
+    delay(ms);
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+#endif
+}
+//----------------------------------------------------------------
+// Modem startup
+
+bool flxLoRaWANTransportSim::begin(uint32_t baudRate)
+{
+    _started = true;
+    _uartRate = baudRate;
+    return true;
+}
+
+void flxLoRaWANTransportSim::reset(void)
+{
+    // Like the module, the network session is kept over a reset - sends not done are lost
+    _sends.clear();
+}
+//----------------------------------------------------------------
+// Configuration - accepted, not used by the simulation
+
+bool flxLoRaWANTransportSim::getDevEUI(char *devEUI, size_t len)
+{
+    if (!_started || !devEUI || len <= strlen(kSimDevEUI))
+        return false;
+
+    strncpy(devEUI, kSimDevEUI, len);
+    return true;
+}
+
+bool flxLoRaWANTransportSim::setRegion(uint8_t /* region */)
+{
+    return _started;
+}
+
+bool flxLoRaWANTransportSim::setChannelsMask(const char *mask)
+{
+    return _started && mask != nullptr;
+}
+
+bool flxLoRaWANTransportSim::setAppEUI(const char *appEUI)
+{
+    return _started && appEUI != nullptr;
+}
+
+bool flxLoRaWANTransportSim::setAppKey(const char *appKey)
+{
+    return _started && appKey != nullptr;
+}
+
+bool flxLoRaWANTransportSim::setNwkKey(const char *nwkKey)
+{
+    return _started && nwkKey != nullptr;
+}
+
+bool flxLoRaWANTransportSim::setApiOptions(uint8_t /* options */)
+{
+    return _started;
+}
+
+bool flxLoRaWANTransportSim::setClass(char loraClass)
+{
+    if (!_started || loraClass < 'A' || loraClass > 'C')
+        return false;
+
+    _loraClass = loraClass;
+    return true;
+}
+
+bool flxLoRaWANTransportSim::writeConfig(void)
+{
+    return _started;
+}
+
+bool flxLoRaWANTransportSim::applyChanges(void)
+{
+    return _started;
+}
+//----------------------------------------------------------------
+// Network - the join blocks, like the module
+
+bool flxLoRaWANTransportSim::connect(void)
+{
+    if (!_started)
+        return false;
+
+    if (_joined)
+        return true;
+
+    sleepMS(_joinDelayMS);
+
+    if (chance(_joinFailPercent))
+        return false;
+
+    _joined = true;
+    _nJoins++;
+    return true;
+}
+
+bool flxLoRaWANTransportSim::disconnect(void)
+{
+    _joined = false;
+    return _started;
+}
+
+bool flxLoRaWANTransportSim::isConnected(void)
+{
+    return _started && _joined;
+}
+//----------------------------------------------------------------
+// Sends - queued, each goes on the air once the send before it is done
+
+bool flxLoRaWANTransportSim::sendData(uint8_t port, const uint8_t *payload, size_t len, bool ack)
+{
+    if (!_started || _sends.size() >= kMaxPendingSends || payload == nullptr || len == 0 || len > 255)
+        return false;
+
+    uplink_t theSend;
+    theSend.port = port;
+    theSend.ack = ack ? 1 : 0;
+    theSend.frameId = ++_frameId;
+    theSend.payload.assign(payload, payload + len);
+
+    uint32_t airtimeMS = _airtimeBaseMS + _airtimeByteMS * len;
+
+    // The send status - not joined? Nothing goes on the air
+    if (!_joined)
+    {
+        theSend.status = kLoRaWANTxStatusNotConnected;
+        airtimeMS = 0;
+    }
+    else if (_forcedStatus != kLoRaWANTxStatusSuccess)
+        theSend.status = _forcedStatus;
+    else if (chance(_lossPercent))
+    {
+        theSend.status = kLoRaWANTxStatusAckFailed;
+        _nLost++;
+    }
+    else
+        theSend.status = kLoRaWANTxStatusSuccess;
+
+    // on the air after the sends already queued
+    uint32_t startMS = _clockMS();
+    if (!_sends.empty() && (int32_t)(_sends.back().doneMS - startMS) > 0)
+        startMS = _sends.back().doneMS;
+    theSend.doneMS = startMS + airtimeMS;
+
+    _nSent++;
+    _totalAirtimeMS += airtimeMS;
+    _sends.push_back(std::move(theSend));
+
+    return true;
+}
+//----------------------------------------------------------------
+// Deliver the status of each completed send, and any downlink - Class A receive window after an uplink
+
+void flxLoRaWANTransportSim::process(void)
+{
+    while (!_sends.empty() && (int32_t)(_clockMS() - _sends.front().doneMS) >= 0)
+    {
+        // off the queue first - the callbacks can send
+        uplink_t theSend = std::move(_sends.front());
+        _sends.pop_front();
+
+        flxLoRaWANPacket_t packet;
+        memset(&packet, 0, sizeof(packet));
+        packet.payload = theSend.payload.data();
+        packet.payloadSize = theSend.payload.size();
+        packet.port = theSend.port;
+        packet.ack = theSend.ack;
+        packet.status = theSend.status;
+        packet.frameId = theSend.frameId;
+
+        if (_onMonitor)
+            _onMonitor(_monitorContext, &packet);
+
+        if (_onSend)
+            _onSend(_cbContext, &packet);
+
+        if (theSend.status != kLoRaWANTxStatusSuccess || _downlinks.empty())
+            continue;
+
+        downlink_t theDownlink = std::move(_downlinks.front());
+        _downlinks.pop_front();
+
+        memset(&packet, 0, sizeof(packet));
+        packet.payload = theDownlink.payload.data();
+        packet.payloadSize = theDownlink.payload.size();
+        packet.port = theDownlink.port;
+        packet.rssi = -70 - (int16_t)(_random() % 40);
+        packet.snr = 8 - (int8_t)(_random() % 16);
+        packet.counter = ++_downlinkCounter;
+
+        if (_onReceive)
+            _onReceive(_cbContext, &packet);
+    }
+}
+//----------------------------------------------------------------
+bool flxLoRaWANTransportSim::queueDownlink(uint8_t port, const uint8_t *payload, size_t len)
+{
+    if (payload == nullptr || len == 0 || len > 242)
+        return false;
+
+    _downlinks.push_back({port, std::vector<uint8_t>(payload, payload + len)});
+    return true;
+}
@@ -0,0 +1,209 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Simulated LoRaWAN modem transport - behaves like the XBee LR module (blocking join, downlinks delivered
+// after an uplink - Class A).
+//
+// The module's sendData() blocks until the transmit is done. The simulation doesn't block - each send is
+// accepted and queued, goes on the air after the sends before it, and its status is reported from the
+// process() call after its airtime has passed. So a burst of sends (the packets of an observation) all go
+// out, in order, as they do with the module.
+//
+// Portable - no Arduino or flux dependencies, so the LoRaWAN packing/connection logic can be exercised
+// and benchmarked on the host. On the board, enabled with the build flag FLX_LORAWAN_SIMULATED_MODEM.
+
+#include "flxLoRaWANTransport.h"
+
+#include <deque>
+#include <random>
+#include <vector>
+
+// Simulation defaults - can be set at build time
+#ifndef FLX_LORAWAN_SIM_JOIN_DELAY_MS
+#define FLX_LORAWAN_SIM_JOIN_DELAY_MS 2000
+#endif
+
+#ifndef FLX_LORAWAN_SIM_LOSS_PERCENT
+#define FLX_LORAWAN_SIM_LOSS_PERCENT 0
+#endif
+
+class flxLoRaWANTransportSim : public flxLoRaWANTransport
+{
+  public:
+    // Max sends waiting to go on the air - sendData() fails when this many are queued
+    static constexpr size_t kMaxPendingSends = 32;
+
+    flxLoRaWANTransportSim();
+
+    const char *name(void)
+    {
+        return "Simulated";
+    }
+
+    bool begin(uint32_t baudRate);
+    void reset(void);
+    uint32_t uartRate(void)
+    {
+        return _uartRate;
+    }
+
+    bool getDevEUI(char *devEUI, size_t len);
+    bool setRegion(uint8_t region);
+    bool setChannelsMask(const char *mask);
+    bool setAppEUI(const char *appEUI);
+    bool setAppKey(const char *appKey);
+    bool setNwkKey(const char *nwkKey);
+    bool setApiOptions(uint8_t options);
+    bool setClass(char loraClass);
+    bool writeConfig(void);
+    bool applyChanges(void);
+
+    bool connect(void);
+    bool disconnect(void);
+    bool isConnected(void);
+    void process(void);
+
+    bool sendData(uint8_t port, const uint8_t *payload, size_t len, bool ack);
+
+    //---------------------------------------------------------------------
+    // Simulation parameters
+
+    // Time a join takes, and the chance (percent) a join attempt fails
+    void setJoinDelay(uint32_t delayMS)
+    {
+        _joinDelayMS = delayMS;
+    }
+    void setJoinFailRate(uint8_t percent)
+    {
+        _joinFailPercent = percent;
+    }
+
+    // Chance (percent) an uplink isn't acknowledged
+    void setLossRate(uint8_t percent)
+    {
+        _lossPercent = percent;
+    }
+
+    // Airtime of an uplink - base time plus time per payload byte
+    void setAirtime(uint32_t baseMS, uint32_t perByteMS)
+    {
+        _airtimeBaseMS = baseMS;
+        _airtimeByteMS = perByteMS;
+    }
+
+    // Force the status code of following sends - kLoRaWANTxStatusSuccess for normal operation
+    void setTxStatus(uint8_t status)
+    {
+        _forcedStatus = status;
+    }
+
+    // Drop the network session - like the network forgetting the device
+    void dropSession(void)
+    {
+        _joined = false;
+    }
+
+    // Queue a downlink - delivered after the next uplink
+    bool queueDownlink(uint8_t port, const uint8_t *payload, size_t len);
+
+    void setSeed(uint32_t seed)
+    {
+        _random.seed(seed);
+    }
+
+    // Called with each uplink as its status is reported - payload included. For checking sends in tests
+    void setMonitor(packetCallback_t onUplink, void *context = nullptr)
+    {
+        _onMonitor = onUplink;
+        _monitorContext = context;
+    }
+
+    // The clock used - defaults to millis() on the board, steady_clock on the host
+    void setClock(uint32_t (*clockMS)(void))
+    {
+        _clockMS = clockMS;
+    }
+
+    //---------------------------------------------------------------------
+    // Statistics
+    uint32_t nJoins(void)
+    {
+        return _nJoins;
+    }
+    uint32_t nSent(void)
+    {
+        return _nSent;
+    }
+    uint32_t nLost(void)
+    {
+        return _nLost;
+    }
+    uint32_t airtime(void)
+    {
+        return _totalAirtimeMS;
+    }
+    // Sends waiting for their status to be reported
+    size_t nPending(void)
+    {
+        return _sends.size();
+    }
+
+  private:
+    bool chance(uint8_t percent);
+    void sleepMS(uint32_t ms);
+
+    // settings
+    uint32_t _joinDelayMS;
+    uint8_t _joinFailPercent;
+    uint8_t _lossPercent;
+    uint32_t _airtimeBaseMS;
+    uint32_t _airtimeByteMS;
+    uint8_t _forcedStatus;
+
+    uint32_t (*_clockMS)(void);
+    std::minstd_rand _random;
+
+    packetCallback_t _onMonitor;
+    void *_monitorContext;
+
+    // modem state
+    bool _started;
+    bool _joined;
+    uint32_t _uartRate;
+    char _loraClass;
+
+    // sends accepted - in the order they go on the air
+    typedef struct
+    {
+        uint8_t port;
+        uint8_t ack;
+        uint8_t status;
+        uint8_t frameId;
+        uint32_t doneMS; // when the transmit is done
+        std::vector<uint8_t> payload;
+    } uplink_t;
+    std::deque<uplink_t> _sends;
+    uint8_t _frameId;
+
+    typedef struct
+    {
+        uint8_t port;
+        std::vector<uint8_t> payload;
+    } downlink_t;
+    std::deque<downlink_t> _downlinks;
+
+    uint32_t _nJoins;
+    uint32_t _nSent;
+    uint32_t _nLost;
+    uint32_t _totalAirtimeMS;
+    uint32_t _downlinkCounter;
+};
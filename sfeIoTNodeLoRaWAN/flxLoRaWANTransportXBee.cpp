@@ -0,0 +1,340 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxLoRaWANTransportXBee.h"
+
+#include <xbee_lr.h>
+
+#define kXBeeLRSerial Serial1
+#define kXBeeLRBaud 9600
+
+// Receive FIFO size for the module UART - at the higher rates, a full frame arrives before the loop runs
+#define kXBeeLRSerialFIFOSize 256
+
+// Timeout waiting on a AT command response during baud negotiation (ms)
+const uint32_t kXBeeATResponseTime = 100;
+
+// Time for the module to switch to a new UART rate (ms)
+const uint32_t kXBeeBaudSwitchTime = 50;
+
+// UART rates the module supports - the first is the module default
+static const uint32_t kXBeeBaudRates[] = {kXBeeLRBaud, 115200, 230400};
+
+// The XBee library callbacks have no context - this is the active transport
+flxLoRaWANTransportXBee *flxLoRaWANTransportXBee::_theTransport = nullptr;
+
+//----------------------------------------------------------------
+// Callbacks from the XBee library - convert the packet and pass it on
+
+static void xbeeToPacket(XBeeLRPacket_t *xbPacket, flxLoRaWANPacket_t &packet)
+{
+    packet.payload = xbPacket->payload;
+    packet.payloadSize = xbPacket->payloadSize;
+    packet.port = xbPacket->port;
+    packet.ack = xbPacket->ack;
+    packet.rssi = xbPacket->rssi;
+    packet.snr = xbPacket->snr;
+    packet.counter = xbPacket->counter;
+    packet.status = xbPacket->status;
+    packet.frameId = xbPacket->frameId;
+}
+
+void flxLoRaWANTransportXBee::onReceiveCB(void *data)
+{
+    if (!_theTransport || !_theTransport->_onReceive || !data)
+        return;
+
+    flxLoRaWANPacket_t packet;
+    xbeeToPacket((XBeeLRPacket_t *)data, packet);
+    _theTransport->_onReceive(_theTransport->_cbContext, &packet);
+}
+
+void flxLoRaWANTransportXBee::onSendCB(void *data)
+{
+    if (!_theTransport || !_theTransport->_onSend || !data)
+        return;
+
+    flxLoRaWANPacket_t packet;
+    xbeeToPacket((XBeeLRPacket_t *)data, packet);
+    _theTransport->_onSend(_theTransport->_cbContext, &packet);
+}
+//----------------------------------------------------------------
+flxLoRaWANTransportXBee::flxLoRaWANTransportXBee() : _pXBeeLR{nullptr}, _uartRate{0}
+{
+    _theTransport = this;
+}
+
+flxLoRaWANTransportXBee::~flxLoRaWANTransportXBee()
+{
+    if (_pXBeeLR)
+    {
+        delete _pXBeeLR;
+        _pXBeeLR = nullptr;
+    }
+    if (_theTransport == this)
+        _theTransport = nullptr;
+}
+//----------------------------------------------------------------
+// Start the module - on the first call, the module object is created
+
+bool flxLoRaWANTransportXBee::begin(uint32_t baudRate)
+{
+    if (!_pXBeeLR)
+    {
+        kXBeeLRSerial.setFIFOSize(kXBeeLRSerialFIFOSize);
+        _pXBeeLR = new XBeeArduino(&kXBeeLRSerial, kXBeeLRBaud, XBEE_LORA, onReceiveCB, onSendCB);
+        if (!_pXBeeLR)
+            return false;
+    }
+    if (!_pXBeeLR->begin())
+        return false;
+
+    // Setup the UART rate
+    _uartRate = negotiateBaud(baudRate);
+
+    return true;
+}
+
+void flxLoRaWANTransportXBee::reset(void)
+{
+    if (_pXBeeLR)
+        _pXBeeLR->reset();
+}
+//----------------------------------------------------------------
+// Configuration
+
+bool flxLoRaWANTransportXBee::getDevEUI(char *devEUI, size_t len)
+{
+    return _pXBeeLR && _pXBeeLR->getLoRaWANDevEUI(devEUI, len);
+}
+
+bool flxLoRaWANTransportXBee::setRegion(uint8_t region)
+{
+    return _pXBeeLR && _pXBeeLR->setLoRaWANRegion(region);
+}
+
+bool flxLoRaWANTransportXBee::setChannelsMask(const char *mask)
+{
+    return _pXBeeLR && _pXBeeLR->setLoRaWANChannelsMask(mask);
+}
+
+bool flxLoRaWANTransportXBee::setAppEUI(const char *appEUI)
+{
+    return _pXBeeLR && _pXBeeLR->setLoRaWANAppEUI(appEUI);
+}
+
+bool flxLoRaWANTransportXBee::setAppKey(const char *appKey)
+{
+    return _pXBeeLR && _pXBeeLR->setLoRaWANAppKey(appKey);
+}
+
+bool flxLoRaWANTransportXBee::setNwkKey(const char *nwkKey)
+{
+    return _pXBeeLR && _pXBeeLR->setLoRaWANNwkKey(nwkKey);
+}
+
+bool flxLoRaWANTransportXBee::setApiOptions(uint8_t options)
+{
+    return _pXBeeLR && _pXBeeLR->setApiOptions(options);
+}
+
+bool flxLoRaWANTransportXBee::setClass(char loraClass)
+{
+    return _pXBeeLR && _pXBeeLR->setLoRaWANClass(loraClass);
+}
+
+bool flxLoRaWANTransportXBee::writeConfig(void)
+{
+    return _pXBeeLR && _pXBeeLR->writeConfig();
+}
+
+bool flxLoRaWANTransportXBee::applyChanges(void)
+{
+    return _pXBeeLR && _pXBeeLR->applyChanges();
+}
+//----------------------------------------------------------------
+// Network
+
+bool flxLoRaWANTransportXBee::connect(void)
+{
+    return _pXBeeLR && _pXBeeLR->connect();
+}
+
+bool flxLoRaWANTransportXBee::disconnect(void)
+{
+    return _pXBeeLR && _pXBeeLR->disconnect();
+}
+
+bool flxLoRaWANTransportXBee::isConnected(void)
+{
+    return _pXBeeLR && _pXBeeLR->isConnected();
+}
+
+void flxLoRaWANTransportXBee::process(void)
+{
+    if (_pXBeeLR)
+        _pXBeeLR->process();
+}
+
+bool flxLoRaWANTransportXBee::sendData(uint8_t port, const uint8_t *payload, size_t len, bool ack)
+{
+    if (!_pXBeeLR)
+        return false;
+
+    XBeeLRPacket_t packet;
+    packet.payload = (uint8_t *)payload;
+    packet.payloadSize = len;
+    packet.port = port;
+    packet.ack = ack ? 1 : 0;
+
+    return _pXBeeLR->sendData(packet);
+}
+//----------------------------------------------------------------
+// UART baud negotiation
+//
+// The module UART rate (BD) is stored in the module. At startup the rate the module is using is found,
+// and if needed, the module is switched to the requested rate. This runs before the XBee library
+// uses the link, so AT command API frames are sent/read directly on the serial port.
+//----------------------------------------------------------------
+// XBee BD parameter values for the supported rates
+static uint8_t xbeeBaudCode(uint32_t baudRate)
+{
+    switch (baudRate)
+    {
+    case 115200:
+        return 7;
+    case 230400:
+        return 8;
+    default:
+        return 3; // 9600
+    }
+}
+//----------------------------------------------------------------
+// Send a AT command API frame (type 0x08) and wait for the response frame (type 0x88). Returns true
+// if the module responded OK.
+
+static bool xbeeATCommand(const char *cmd, const uint8_t *param = nullptr, uint8_t paramLen = 0)
+{
+    const uint8_t kFrameID = 0x52;
+
+    // drop anything pending
+    while (kXBeeLRSerial.available() > 0)
+        kXBeeLRSerial.read();
+
+    uint8_t frame[12];
+    uint16_t len = 4 + paramLen; // type, id, command
+    if (len + 4 > sizeof(frame))
+        return false;
+
+    frame[0] = 0x7E;
+    frame[1] = len >> 8;
+    frame[2] = len & 0xFF;
+    frame[3] = 0x08;
+    frame[4] = kFrameID;
+    frame[5] = cmd[0];
+    frame[6] = cmd[1];
+
+    // no parameter for a query or an action command
+    if (paramLen > 0)
+        memcpy(frame + 7, param, paramLen);
+
+    uint8_t sum = 0;
+    for (int i = 3; i < len + 3; i++)
+        sum += frame[i];
+    frame[len + 3] = 0xFF - sum;
+
+    kXBeeLRSerial.write(frame, len + 4);
+    kXBeeLRSerial.flush();
+
+    // Read the response - header, then the frame body: type, id, command, status
+    uint8_t buffer[8];
+    uint16_t nRead = 0;
+    uint16_t frameLen = 0;
+
+    for (uint32_t startMS = millis(); millis() - startMS < kXBeeATResponseTime;)
+    {
+        if (kXBeeLRSerial.available() <= 0)
+        {
+            delay(1);
+            continue;
+        }
+        uint8_t chIn = kXBeeLRSerial.read();
+
+        // waiting on a start delimiter?
+        if (nRead == 0 && chIn != 0x7E)
+            continue;
+
+        if (nRead < sizeof(buffer))
+            buffer[nRead] = chIn;
+        nRead++;
+
+        if (nRead == 3)
+            frameLen = (buffer[1] << 8) | buffer[2];
+
+        // have the type, id, command and status?
+        if (nRead == 8)
+        {
+            if (frameLen >= 5 && buffer[3] == 0x88 && buffer[4] == kFrameID && buffer[5] == cmd[0] &&
+                buffer[6] == cmd[1])
+                return buffer[7] == 0;
+
+            // not our frame - wait for the next one
+            nRead = 0;
+        }
+    }
+    return false;
+}
+//----------------------------------------------------------------
+// Is the module responding at the given rate?
+static bool xbeeCheckBaud(uint32_t baudRate)
+{
+    kXBeeLRSerial.begin(baudRate);
+    return xbeeATCommand("BD");
+}
+//----------------------------------------------------------------
+// Find the rate the module is using and switch it to the target rate. Returns the rate in use, 0 if
+// the module didn't respond.
+//
+// Note: no logging - this can be called from a background task
+
+uint32_t flxLoRaWANTransportXBee::negotiateBaud(uint32_t targetRate)
+{
+    // Find the module rate - start with the target, it was set on a previous boot
+    uint32_t currentRate = 0;
+    if (xbeeCheckBaud(targetRate))
+        return targetRate;
+
+    for (int i = 0; i < sizeof(kXBeeBaudRates) / sizeof(kXBeeBaudRates[0]); i++)
+    {
+        if (kXBeeBaudRates[i] != targetRate && xbeeCheckBaud(kXBeeBaudRates[i]))
+        {
+            currentRate = kXBeeBaudRates[i];
+            break;
+        }
+    }
+    // No response - leave the link at the module default
+    if (currentRate == 0)
+    {
+        kXBeeLRSerial.begin(kXBeeLRBaud);
+        return 0;
+    }
+
+    // Switch the module - set, save and apply the new rate
+    uint8_t code = xbeeBaudCode(targetRate);
+    if (xbeeATCommand("BD", &code, 1) && xbeeATCommand("WR") && xbeeATCommand("AC"))
+    {
+        delay(kXBeeBaudSwitchTime);
+        if (xbeeCheckBaud(targetRate))
+            return targetRate;
+    }
+
+    // the switch failed - fallback to the rate that works
+    return xbeeCheckBaud(currentRate) ? currentRate : 0;
+}
@@ -0,0 +1,66 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// LoRaWAN transport for the Digi XBee LR module - uses the XBee Arduino library on Serial1
+
+#include "flxLoRaWANTransport.h"
+
+#include <XBeeArduino.h>
+
+class flxLoRaWANTransportXBee : public flxLoRaWANTransport
+{
+  public:
+    flxLoRaWANTransportXBee();
+    ~flxLoRaWANTransportXBee();
+
+    const char *name(void)
+    {
+        return "XBee LR";
+    }
+
+    bool begin(uint32_t baudRate);
+    void reset(void);
+    uint32_t uartRate(void)
+    {
+        return _uartRate;
+    }
+
+    bool getDevEUI(char *devEUI, size_t len);
+    bool setRegion(uint8_t region);
+    bool setChannelsMask(const char *mask);
+    bool setAppEUI(const char *appEUI);
+    bool setAppKey(const char *appKey);
+    bool setNwkKey(const char *nwkKey);
+    bool setApiOptions(uint8_t options);
+    bool setClass(char loraClass);
+    bool writeConfig(void);
+    bool applyChanges(void);
+
+    bool connect(void);
+    bool disconnect(void);
+    bool isConnected(void);
+    void process(void);
+
+    bool sendData(uint8_t port, const uint8_t *payload, size_t len, bool ack);
+
+  private:
+    uint32_t negotiateBaud(uint32_t targetRate);
+
+    static void onReceiveCB(void *data);
+    static void onSendCB(void *data);
+
+    // the XBee library callbacks have no context - so track the active transport
+    static flxLoRaWANTransportXBee *_theTransport;
+
+    XBeeArduino *_pXBeeLR;
+    uint32_t _uartRate;
+};
@@ -0,0 +1,43 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// SHA-256 (FIPS 180-4) digest - computed incrementally, so a large file can be hashed a piece at a time.
+//
+// Portable - no Arduino or flux dependencies.
+
+#include <cstddef>
+#include <cstdint>
+
+class flxSHA256
+{
+  public:
+    static constexpr size_t kDigestSize = 32;
+
+    flxSHA256()
+    {
+        begin();
+    }
+
+    void begin(void);
+    void update(const uint8_t *data, size_t len);
+
+    // The digest of the data added since begin()
+    void finish(uint8_t digest[kDigestSize]);
+
+  private:
+    void transform(const uint8_t block[64]);
+
+    uint32_t _state[8];
+    uint64_t _length; // bytes added
+    uint8_t _block[64];
+    size_t _blockLen;
+};
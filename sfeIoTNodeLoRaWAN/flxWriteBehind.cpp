@@ -0,0 +1,199 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "flxWriteBehind.h"
+
+#include <cstring>
+
+// Default time data less than a sector is held - in secs
+const uint32_t kWriteBehindDefaultFlushTime = 10;
+
+// Delay from a full sector being buffered to the write - after the log cycle completes (ms)
+const uint32_t kWriteBehindSectorDelay = 250;
+
+static flxJobMetrics _metricsWrite("SD Write");
+
+//----------------------------------------------------------------
+flxWriteBehind::flxWriteBehind()
+    : _pTarget{nullptr}, _used{0}, _firstTicks{0}, _flush_time{kWriteBehindDefaultFlushTime}, _writeQueued{false},
+      _writeAll{false}, _nStalls{0}, _nWrites{0}
+{
+    setName("SD Write Buffer", "Buffers data written to the SD card");
+
+    flxRegister(flushTime, "Flush Time",
+                "Seconds to hold data less than a card sector before writing it. Held data is lost on power loss");
+
+    _writeJob.setup("SD Write", kWriteBehindSectorDelay, this, &flxWriteBehind::writeJobCB);
+
+    flux_add(this);
+}
+//----------------------------------------------------------------
+uint32_t flxWriteBehind::get_flush_time(void)
+{
+    return _flush_time;
+}
+
+void flxWriteBehind::set_flush_time(uint32_t secs)
+{
+    _flush_time = secs;
+}
+//----------------------------------------------------------------
+// flxWriter interface
+//
+void flxWriteBehind::write(int value)
+{
+    char szBuffer[16];
+    snprintf(szBuffer, sizeof(szBuffer), "%d", value);
+    write(szBuffer, false);
+}
+
+void flxWriteBehind::write(float value)
+{
+    char szBuffer[24];
+    snprintf(szBuffer, sizeof(szBuffer), "%f", value);
+    write(szBuffer, false);
+}
+
+void flxWriteBehind::write(const char *value, bool newline)
+{
+    if (value != nullptr)
+        append(value, strlen(value));
+    if (newline)
+        append("\n", 1);
+
+    scheduleWrite();
+}
+//----------------------------------------------------------------
+void flxWriteBehind::append(const char *data, size_t len)
+{
+    while (len > 0)
+    {
+        // full? Write it out now - the one time logging waits on the card
+        if (_used == kBufferSize)
+        {
+            _nStalls++;
+            writeBuffer(kBufferSize);
+        }
+        if (_used == 0)
+            _firstTicks = millis();
+
+        size_t nCopy = kBufferSize - _used < len ? kBufferSize - _used : len;
+        memcpy(_buffer + _used, data, nCopy);
+        _used += nCopy;
+        data += nCopy;
+        len -= nCopy;
+    }
+}
+//----------------------------------------------------------------
+// Queue the write job - soon if there's a full sector, else at the flush time of the oldest data
+//
+void flxWriteBehind::scheduleWrite(void)
+{
+    if (_used == 0)
+        return;
+
+    uint32_t delayMS = kWriteBehindSectorDelay;
+    if (_used < kSectorSize)
+    {
+        uint32_t heldMS = millis() - _firstTicks;
+        delayMS = _flush_time * 1000 > heldMS ? _flush_time * 1000 - heldMS : 0;
+        if (delayMS < kWriteBehindSectorDelay)
+            delayMS = kWriteBehindSectorDelay;
+    }
+    // already queued for this time or sooner?
+    if (_writeQueued && _writeJob.period() <= delayMS)
+        return;
+
+    _writeJob.setPeriod(delayMS);
+    if (_writeQueued)
+        flxUpdateJobInQueue(_writeJob);
+    else
+        flxAddJobToQueue(_writeJob);
+
+    _writeQueued = true;
+}
+//----------------------------------------------------------------
+// The write job - write the full sectors, and the rest if it's been held for the flush time
+//
+void flxWriteBehind::writeJobCB(void)
+{
+    flxJobMetricsScope metrics(_metricsWrite, _writeJob);
+
+    size_t len = _used - (_used % kSectorSize);
+    if (_writeAll || millis() - _firstTicks >= _flush_time * 1000)
+        len = _used;
+    _writeAll = false;
+
+    writeBuffer(len);
+
+    if (_used == 0)
+    {
+        flxRemoveJobFromQueue(_writeJob);
+        _writeQueued = false;
+        return;
+    }
+    // the rest at its flush time
+    uint32_t heldMS = millis() - _firstTicks;
+    _writeJob.setPeriod(_flush_time * 1000 > heldMS ? _flush_time * 1000 - heldMS : kWriteBehindSectorDelay);
+    flxUpdateJobInQueue(_writeJob);
+}
+//----------------------------------------------------------------
+void flxWriteBehind::flush(void)
+{
+    writeBuffer(_used);
+    _writeAll = false;
+
+    if (_writeQueued)
+    {
+        flxRemoveJobFromQueue(_writeJob);
+        _writeQueued = false;
+    }
+}
+//----------------------------------------------------------------
+void flxWriteBehind::writeSoon(void)
+{
+    if (_used == 0)
+        return;
+
+    _writeAll = true;
+    _writeJob.setPeriod(kWriteBehindSectorDelay);
+    if (_writeQueued)
+        flxUpdateJobInQueue(_writeJob);
+    else
+        flxAddJobToQueue(_writeJob);
+
+    _writeQueued = true;
+}
+//----------------------------------------------------------------
+// Write the first len bytes of the buffer to the file, then sync the file
+//
+void flxWriteBehind::writeBuffer(size_t len)
+{
+    if (len == 0 || len > _used)
+        return;
+
+    if (_pTarget != nullptr)
+    {
+        // the file takes strings - terminate the block, and restore the byte after
+        char chSave = _buffer[len];
+        _buffer[len] = '\0';
+        _pTarget->write(_buffer, false);
+        _buffer[len] = chSave;
+
+        _pTarget->flush();
+        _nWrites++;
+    }
+    _used -= len;
+    if (_used > 0)
+    {
+        memmove(_buffer, _buffer + len, _used);
+        _firstTicks = millis();
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Write-behind buffer for the SD card data file. Log output is copied to a RAM buffer, so logging doesn't
+// wait on the card - card writes can take 100+ ms when the card allocates a cluster.
+//
+// The buffer is written to the card by a job that runs after the log cycle, in whole sectors (512 bytes).
+// Data less than a sector is written once it has been held for the flush time. After each write, the file
+// is synced, so data written is safe from a power loss - buffered data, up to the flush time of it, is not.
+//
+// The card is only used from the main loop (the job) - it's shared with the settings storage and firmware
+// loader, which don't lock it.
+
+#include "flxJobMetrics.h"
+#include <Flux/flxCore.h>
+#include <Flux/flxCoreJobs.h>
+#include <Flux/flxFileRotate.h>
+
+class flxWriteBehind : public flxActionType<flxWriteBehind>, public flxWriter
+{
+  private:
+    uint32_t get_flush_time(void);
+    void set_flush_time(uint32_t secs);
+
+  public:
+    static constexpr size_t kSectorSize = 512;
+    static constexpr size_t kBufferSize = 16 * kSectorSize;
+
+    flxWriteBehind();
+
+    // The file the data is written to
+    void setTarget(flxFileRotate &theFile)
+    {
+        _pTarget = &theFile;
+    }
+
+    // flxWriter interface
+    void write(int value);
+    void write(float value);
+    void write(const char *value, bool newline);
+
+    // Write all buffered data to the card now
+    void flush(void);
+
+    // Write all buffered data to the card - by the write job, after the log cycle
+    void writeSoon(void);
+
+    // bytes waiting, times the buffer filled (and was written while logging), and the number of card writes
+    size_t bytesBuffered(void)
+    {
+        return _used;
+    }
+    uint32_t nStalls(void)
+    {
+        return _nStalls;
+    }
+    uint32_t nWrites(void)
+    {
+        return _nWrites;
+    }
+
+    // Seconds data less than a sector is held before it's written
+    flxPropertyRWUInt32<flxWriteBehind, &flxWriteBehind::get_flush_time, &flxWriteBehind::set_flush_time> flushTime =
+        {1, 600};
+
+  private:
+    void append(const char *data, size_t len);
+    void writeJobCB(void);
+    void writeBuffer(size_t len);
+    void scheduleWrite(void);
+
+    flxFileRotate *_pTarget;
+
+    char _buffer[kBufferSize + 1];
+    size_t _used;
+    uint32_t _firstTicks; // when the oldest buffered data was added
+
+    uint32_t _flush_time;
+    flxJob _writeJob;
+    bool _writeQueued;
+    bool _writeAll; // next write job writes all the data
+
+    uint32_t _nStalls;
+    uint32_t _nWrites;
+};
@@ -16,22 +16,96 @@
 #include <Arduino.h>
 
 #include <Flux/flxDevButton.h>
+#include <Flux/flxDevGNSS.h>
+#include <Flux/flxDevRV8803.h>
 #include <Flux/flxSerial.h>
 
+#include <sys/time.h>
+#include <tusb.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
 static const char *kProductName = "SparkFun IoT Node LoRaWAN";
 
 // Startup/Timeout for serial connection to init...
 #define kSerialStartupDelayMS 5000
 
+// Time to wait for USB to mount - if no USB host, we don't wait for serial
+#define kSerialUSBMountDelayMS 750
+
 // delay used in loop during startup
 const uint32_t kStartupLoopDelayMS = 70;
 
 // Button event increment
 #define kButtonPressedIncrement 5
 
+// Run time accounting for the logger and battery jobs
+static flxJobMetrics _metricsLogger("Logger");
+static flxJobMetrics _metricsBattery("Battery");
+
+// Fuel gauge alerts - low state of charge (%) and low voltage (V) levels
+const uint8_t kFuelGaugeAlertSOC = 10;
+const float kFuelGaugeAlertVoltage = 3.3;
+
+// The low voltage alert is set for as long as the voltage is low - so it's turned off when it fires, and back
+// on once the voltage is above this level (V)
+const float kFuelGaugeAlertVoltageRestore = 3.5;
+
+// Set by the fuel gauge ALRT pin ISR - handled in the main loop, which the ISR wakes
+static volatile bool fuelGaugeAlert = false;
+static TaskHandle_t hFuelGaugeAlertTask = NULL;
+
+static void fuelGaugeAlertISR(void)
+{
+    fuelGaugeAlert = true;
+
+    if (hFuelGaugeAlertTask == NULL)
+        return;
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(hFuelGaugeAlertTask, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+// Qwiic power gating - default device warm-up time after power on (ms)
+const uint32_t kQwiicDefaultWarmupMS = 100;
+
+// Aligned logging - the clock is set if later than this (2024-01-01). In secs.
+const time_t kAlignedLogValidEpoch = 1704067200;
+
+// Aligned logging - a log boundary closer than this (ms) is skipped, it was just logged
+const uint32_t kAlignedLogMinWaitMS = 1000;
+
+// Log jitter - the most the first log after a join is delayed, and the most each interval is delayed as
+// a fraction (1/N) of the log interval, capped. In ms.
+const uint32_t kLogJitterFirstMaxMS = 30000;
+const uint32_t kLogJitterIntervalDivisor = 10;
+const uint32_t kLogJitterIntervalMaxMS = 30000;
+
+// Job stats on the SD card - the file, and how often the stats are written (ms)
+#define kJobStatsFile "/job_stats.csv"
+const uint32_t kJobStatsInterval = 3600000;
+
+// Main loop wait between passes - in ms
+const uint32_t kAppLoopDelayMS = 10;
+
+// Low power idle - the longest the main loop will idle, and how long it stays awake after a log event (for
+// the transmit) and after the transmit status (for the receive windows) - in ms
+const uint32_t kLowPowerMaxIdleMS = 30000;
+const uint32_t kLowPowerLogAwakeMS = 10000;
+const uint32_t kLowPowerRxAwakeMS = 8000;
+
 //---------------------------------------------------------------------------
 // LoRaWAN Receive message ids
 //
+// The port for the LED messages
+const uint8_t kLoRaWANMsgLEDPort = 2;
+
+// The port for battery saver tier uplinks, and the payload version
+const uint8_t kLoRaWANBatteryTierPort = 7;
+const uint8_t kLoRaWANBatteryTierVersion = 1;
+
 // Set the on-board LED to the RGB value in the message
 const uint8_t kLoRaWANMsgLEDRGB = 0x01;
 
@@ -79,7 +153,8 @@ static const uint8_t _app_jump[] = {104, 72, 67, 51,  74,  67,  108, 99, 104, 11
 //---------------------------------------------------------------------------
 //
 sfeIoTNodeLoRaWAN::sfeIoTNodeLoRaWAN()
-    : _logTypeSD{kAppLogTypeNone}, _logTypeSer{kAppLogTypeNone}, _opFlags{0}, _hasOnBoardFlashFS{false}
+    : _logTypeSD{kAppLogTypeNone}, _logTypeSer{kAppLogTypeNone}, _logIntervalsSkipped{0}, _opFlags{0},
+      _hasOnBoardFlashFS{false}, _hasConnected{false}, _nextLogTicks{0}, _awakeUntilTicks{0}
 {
     // Constructor
 }
@@ -113,6 +188,61 @@ void sfeIoTNodeLoRaWAN::getStartupProperties(uint32_t &baudRate, uint32_t &start
 
     _sysStorage.endBlock(stBlk);
 }
+//---------------------------------------------------------------------------
+// Should the LoRaWAN module join at startup, before settings are restored? Only if the connection is
+// enabled and the module was configured on a previous boot. Also returns the module UART rate.
+bool sfeIoTNodeLoRaWAN::getStartupLoRaWANJoin(uint32_t &baudRate)
+{
+    baudRate = _loraWANConnection.moduleBaudRate();
+
+    flxStorageBlock *stBlk = _sysStorage.getBlock(_loraWANConnection.name());
+
+    if (!stBlk)
+        return false;
+
+    // Note: the connection registers its properties later in startup, so use the stored names
+    bool bEnabled;
+    if (!stBlk->read("Enabled", bEnabled))
+        bEnabled = true;
+
+    uint32_t moduleConfig;
+    if (!stBlk->read("mod-cfg-id", moduleConfig))
+        moduleConfig = 0;
+
+    uint32_t theRate;
+    if (stBlk->read("Module Baud Rate", theRate))
+        baudRate = theRate;
+
+    _sysStorage.endBlock(stBlk);
+
+    return bEnabled && moduleConfig != 0;
+}
+//---------------------------------------------------------------------------
+// Boot timing
+void sfeIoTNodeLoRaWAN::markBootPhase(bootPhase_t phase)
+{
+    if (phase < kBootPhaseCount && _bootPhaseTicks[phase] == 0)
+        _bootPhaseTicks[phase] = millis();
+}
+
+void sfeIoTNodeLoRaWAN::displayBootTimes(void)
+{
+    static const char *kBootPhaseNames[] = {"Init",    "Setup",             "Device Load", "Start",
+                                            "Started", "LoRaWAN Connected", "First Uplink"};
+
+    flxLog_N(F("Boot Times (ms since power on):"));
+    uint32_t lastTicks = 0;
+    for (int i = 0; i < kBootPhaseCount; i++)
+    {
+        if (_bootPhaseTicks[i] == 0)
+        {
+            flxLog_N(F("    %-20s  -"), kBootPhaseNames[i]);
+            continue;
+        }
+        flxLog_N(F("    %-20s  %6u  (+%u)"), kBootPhaseNames[i], _bootPhaseTicks[i], _bootPhaseTicks[i] - lastTicks);
+        lastTicks = _bootPhaseTicks[i];
+    }
+}
 ///
 /// @brief Checks for any before startup commands from the user
 ///
@@ -207,6 +337,7 @@ void sfeIoTNodeLoRaWAN::onInitStartupCommands(uint32_t delaySecs)
 //
 void sfeIoTNodeLoRaWAN::onInit()
 {
+    markBootPhase(kBootPhaseInit);
 
     // Add a title for this section - the application level  - of settings
     setTitle("General");
@@ -224,6 +355,11 @@ void sfeIoTNodeLoRaWAN::onInit()
     flxRegister(serialLogType, "Serial Console Format", "Enable and set the output format");
     flxRegister(sdCardLogType, "SD Card Format", "Enable and set the output format");
     flxRegister(jsonBufferSize, "JSON Buffer Size", "Output buffer size in bytes");
+    flxRegister(alignedLogging, "Aligned Logging", "Log at clock times that are multiples of the log interval");
+    flxRegister(deviceLogOffset, "Device Log Offset",
+                "Offset aligned log times by a per device amount - to spread uplinks from several boards");
+    flxRegister(logJitter, "Log Jitter",
+                "Add a small random delay to log events - to spread uplinks from several boards");
 
     // Terminal Serial Baud Rate
     flxRegister(serialBaudRate, "Terminal Baud Rate", "Update terminal baud rate. Changes take effect on restart");
@@ -231,11 +367,23 @@ void sfeIoTNodeLoRaWAN::onInit()
 
     enableSoilSensor.setTitle("Devices");
     flxRegister(enableSoilSensor, "Soil Moisture Sensor", "Enable GPIO attached Soil Moisture Sensor");
+
+    lowPowerIdle.setTitle("Power");
+    flxRegister(lowPowerIdle, "Low Power Idle", "Idle between log events when not connected to USB");
+    flxRegister(batterySaver, "Battery Saver", "Log and send data less often as the battery drains");
+    flxRegister(fuelGaugeAlertPin, "Fuel Gauge Alert Pin",
+                "GPIO connected to the fuel gauge ALRT output. 255 to disable. Changes take effect on restart");
+    flxRegister(qwiicPowerGating, "Qwiic Power Saving",
+                "Power Qwiic devices only when they are used. Changes take effect on restart");
+    flxRegister(qwiicWarmupTime, "Qwiic Warm-up Time",
+                "Time (ms) Qwiic devices need after power on - unless set on the device. Takes effect on restart");
+    qwiicWarmupTime = kQwiicDefaultWarmupMS;
     // Advanced settings
     verboseDevNames.setTitle("Advanced");
     flxRegister(verboseDevNames, "Device Names", "Name always includes the device address");
     flxRegister(startupDelaySecs, "Startup Delay", "Startup Menu Delay in Seconds");
     flxRegister(verboseEnabled, "Verbose Messages", "Enable verbose messages");
+    flxRegister(jobStatsToSD, "Job Stats to SD", "Write job run time and lateness stats to the SD card every hour");
 
     // about?
     flxRegister(aboutApplication, "About...", "Details about the system");
@@ -263,9 +411,14 @@ void sfeIoTNodeLoRaWAN::onInit()
     // setup Serial
     Serial.begin(theRate);
 
-    // Wait on serial - not sure if a timeout is needed ... but added for safety
+    // Wait on serial - not sure if a timeout is needed ... but added for safety. If USB doesn't mount,
+    // there is no host/terminal (on battery) - so don't wait.
     for (uint32_t startMS = millis(); !Serial && millis() - startMS <= kSerialStartupDelayMS;)
-        delay(250);
+    {
+        if (!tud_mounted() && millis() - startMS > kSerialUSBMountDelayMS)
+            break;
+        delay(50);
+    }
 
     // flush serial - needed for initial output to work
     Serial.println();
@@ -292,6 +445,14 @@ void sfeIoTNodeLoRaWAN::onInit()
 bool sfeIoTNodeLoRaWAN::onSetup()
 {
     // flxLog_I("in onSetup()");
+    markBootPhase(kBootPhaseSetup);
+
+    // Start the LoRaWAN module in the background - the module startup and network join overlap with
+    // device discovery and settings restore. Join early only if the module was setup on a previous boot.
+    uint32_t moduleBaud = _loraWANConnection.moduleBaudRate();
+    bool bJoin = !inOpMode(kAppOpStartNoSettings) && getStartupLoRaWANJoin(moduleBaud);
+    _loraWANConnection.startBackgroundJoin(bJoin, moduleBaud);
+
     setName(kProductName);
     setDescription(kDLVersionBoardDesc);
 
@@ -312,12 +473,20 @@ bool sfeIoTNodeLoRaWAN::onSetup()
     // Event Callback for lorawan send status
     flxRegisterEventCB(flxEvent::kLoRaWANSendStatus, this, &sfeIoTNodeLoRaWAN::onLoRaWANSendEvent);
 
-    // Event Callback for lorawan receive status
-    flxRegisterEventCB(flxEvent::kLoRaWANReceivedMessage, this, &sfeIoTNodeLoRaWAN::onLoRaWANReceiveEvent);
+    // Downlink messages for the on-board LED
+    for (uint8_t opcode = kLoRaWANMsgLEDRGB; opcode <= kLoRaWANMsgLEDBrightness; opcode++)
+        _loraWANConnection.downlink().registerHandler(kLoRaWANMsgLEDPort, opcode, this,
+                                                      &sfeIoTNodeLoRaWAN::onLEDDownlink);
+
+    // Event Callback for lorawan connection changes
+    flxRegisterEventCB(flxEvent::kOnConnectionChange, this, &sfeIoTNodeLoRaWAN::onLoRaWANConnectionChange);
 
     // for system reset event
     flxRegisterEventCB(flxEvent::kOnSystemReset, this, &sfeIoTNodeLoRaWAN::onSystemResetEvent);
 
+    // the device restarts to install firmware received via LoRaWAN
+    flxRegisterEventCB(flxEvent::kLoRaWANFirmwareInstall, this, &sfeIoTNodeLoRaWAN::prepareRestart);
+
     // for needs restart event
     flxRegisterEventCB(flxEvent::kSystemNeedsRestart, this, &sfeIoTNodeLoRaWAN::onNeedsRestart);
 
@@ -379,6 +548,7 @@ bool sfeIoTNodeLoRaWAN::onSetup()
 //
 void sfeIoTNodeLoRaWAN::onDeviceLoad()
 {
+    markBootPhase(kBootPhaseDeviceLoad);
 
     // quick check on fuel gauge
     auto fuelGauge = flux_get().get<flxDevMAX17048>();
@@ -394,6 +564,14 @@ void sfeIoTNodeLoRaWAN::onDeviceLoad()
     for (auto b : *buttons)
         b->on_clicked.call(this, &sfeIoTNodeLoRaWAN::onQwiicButtonEvent);
 
+    // Qwiic devices are on the switched rail - the fuel gauge is on the board
+    flxDeviceContainer loadedDevices = flux.connectedDevices();
+    for (auto device : loadedDevices)
+    {
+        if (device->getKind() == flxDeviceKindI2C && device != _fuelGauge)
+            _qwiicPower.addDevice(device);
+    }
+
     // setup our soil sensor device
     _soilSensor.vccPin = kSoilSensorVCCPin;
     _soilSensor.sensorPin = kSoilSensorSensorPin;
@@ -413,10 +591,22 @@ void sfeIoTNodeLoRaWAN::onRestore()
 bool sfeIoTNodeLoRaWAN::onStart()
 {
     // flxLog_I("in onStart()");
+    markBootPhase(kBootPhaseStart);
 
     // Logging is done at an interval - using an interval timer.
     // connect our logger method to the timer interval
-    _timer.on_interval.call(this, &sfeIoTNodeLoRaWAN::onLogEvent);
+    _timer.on_interval.call(this, &sfeIoTNodeLoRaWAN::onLogTimer);
+    _nextLogTicks = millis() + _timer.interval();
+
+    // job for aligned logging - started on a log timer event once the clock is set
+    _logAlignedJob.setup("Aligned Log", _timer.interval(), this, &sfeIoTNodeLoRaWAN::onLogAlignedJob);
+
+    // job stats to the SD card - if enabled
+    _jobStatsJob.setup("Job Stats", kJobStatsInterval, this, &sfeIoTNodeLoRaWAN::onJobStatsJob);
+    flxAddJobToQueue(_jobStatsJob);
+
+    // one shot job for log events delayed by the log jitter
+    _logJitterJob.setup("Log Jitter", kLogJitterFirstMaxMS, this, &sfeIoTNodeLoRaWAN::onLogEvent, false);
 
     //  - Add the JSON and CVS format to the logger
     _logger.add(_fmtJSON);
@@ -449,6 +639,7 @@ bool sfeIoTNodeLoRaWAN::onStart()
                 _logger.add(device);
                 _loraWANLogger.add(device);
             }
+            _remoteConfig.add(device);
         }
     }
 
@@ -459,6 +650,9 @@ bool sfeIoTNodeLoRaWAN::onStart()
     if (!setupTime())
         flxLog_W(F("Time reference setup failed."));
 
+    // Qwiic power gating? Once the devices and clocks are setup
+    setupQwiicPower();
+
     flxLog_N("");
     // Do we have a fuel gauge ...
     if (_fuelGauge)
@@ -466,22 +660,33 @@ bool sfeIoTNodeLoRaWAN::onStart()
         _batteryJob.reset(new flxJob);
         if (_batteryJob != nullptr)
         {
-            _batteryJob->setup("Battery", kBatteryCheckInterval, this, &sfeIoTNodeLoRaWAN::checkBatteryLevels);
+            // with the fuel gauge alert, the job is only a long period check
+            _batteryJob->setup("Battery", setupFuelGaugeAlert() ? kBatteryCheckIntervalAlert : kBatteryCheckInterval,
+                               this, &sfeIoTNodeLoRaWAN::onBatteryJob);
             flxAddJobToQueue(*_batteryJob);
         }
     }
 
-    // now load our LoRaWAN .. delay for the module to initialize
+    // now start our LoRaWAN connection - this runs in the background, if it fails the connection
+    // object drops into reconnect mode.
     if (!_loraWANConnection.connect())
-    {
-        flxLog_N(" - connectivity not available");
-        // put the module in a reconnect state
-        _loraWANConnection.startReconnectMode();
-    }
+        flxLog_I(F("LoRaWAN connectivity not available"));
 
     // connect the LoRaWAN logger to the LoRaWAN object
     _loraWANLogger.setLoRaWAN(&_loraWANConnection);
 
+    // Properties that can be set remotely - the app, logging and the timer, and the loaded devices (above)
+    _remoteConfig.add(this);
+    _remoteConfig.add(_logger);
+    _remoteConfig.add(_timer);
+    _remoteConfig.setLoRaWAN(&_loraWANConnection);
+
+    // Firmware updates via LoRaWAN - when enabled
+    _loraWANUpdate.setLoRaWAN(&_loraWANConnection);
+
+    // Network time - synced after a join and then periodically
+    _loraWANTime.setLoRaWAN(&_loraWANConnection);
+
     // Display detailed app info
     displayAppStatus(true);
 
@@ -497,9 +702,12 @@ bool sfeIoTNodeLoRaWAN::onStart()
 
     sfeLED.off();
 
-    // trigger a log event if we are connected
+    markBootPhase(kBootPhaseStarted);
+
+    // trigger a log event if we are connected - otherwise this happens when the connection is made
     if (_loraWANConnection.isConnected())
-        _timer.trigger();
+        onLoRaWANConnectionChange(true);
+
     return true;
 }
 
@@ -550,17 +758,20 @@ void sfeIoTNodeLoRaWAN::set_logTypeSD(uint8_t logType)
     if (logType == _logTypeSD)
         return;
 
+    // write out data buffered in the old format
+    _sdWriteBuffer.flush();
+
     if (_logTypeSD == kAppLogTypeCSV)
-        _fmtCSV.remove(&_theOutputFile);
+        _fmtCSV.remove(&_sdWriteBuffer);
     else if (_logTypeSD == kAppLogTypeJSON)
-        _fmtJSON.remove(&_theOutputFile);
+        _fmtJSON.remove(&_sdWriteBuffer);
 
     _logTypeSD = logType;
 
     if (_logTypeSD == kAppLogTypeCSV)
-        _fmtCSV.add(&_theOutputFile);
+        _fmtCSV.add(&_sdWriteBuffer);
     else if (_logTypeSD == kAppLogTypeJSON)
-        _fmtJSON.add(&_theOutputFile);
+        _fmtJSON.add(&_sdWriteBuffer);
 }
 
 //---------------------------------------------------------------------------
@@ -677,6 +888,7 @@ void sfeIoTNodeLoRaWAN::onSettingsEdit(bool bLoading)
         if (inOpMode(kAppOpPendingRestart))
         {
             flxLog_N("\n\rSome changes required a device restart to take effect...");
+            prepareRestart();
             _sysSystem.restartDevice();
 
             // this shouldn't return unless user aborted
@@ -736,6 +948,7 @@ void sfeIoTNodeLoRaWAN::onButtonPressed(uint32_t increment)
         sfeLED.off();
 
         // Reset time !
+        prepareRestart();
         _sysSystem.resetDevice();
     }
 }
@@ -760,9 +973,133 @@ void sfeIoTNodeLoRaWAN::onNeedsRestart(void)
 // ---------------------------------------------------------------------------
 void sfeIoTNodeLoRaWAN::onLogEvent(void)
 {
-    // Log data - triggered from an event
-    _logger.logObservation();
-    _loraWANLogger.logObservation();
+    // stay awake for the device warm-up and the transmit of this data
+    _awakeUntilTicks = millis() + (_qwiicPower.enabled() ? _qwiicPower.warmupTime() : 0) + kLowPowerLogAwakeMS;
+
+    // Log data - triggered from an event. With Qwiic power saving, this runs once the devices are powered
+    _qwiicPower.run([this]() {
+        flxJobMetricsScope metrics(_metricsLogger);
+
+        _logger.logObservation();
+        _loraWANLogger.logObservation();
+
+        // idling between logs - don't hold data for the flush time, write it after this log cycle
+        if (lowPowerIdle())
+            _sdWriteBuffer.writeSoon();
+    });
+}
+
+//---------------------------------------------------------------------------
+// The log timer - logs relative to the last event. With aligned logging, the timer just starts the
+// aligned log job once the clock is set, then stops - the aligned job owns the schedule, so the timer
+// doesn't wake the board each interval.
+void sfeIoTNodeLoRaWAN::onLogTimer(void)
+{
+    if (alignedLogging() && (_logAlignedActive || scheduleAlignedLog()))
+    {
+        _timer.stop();
+        return;
+    }
+    _nextLogTicks = millis() + _timer.interval();
+    onLogInterval();
+}
+//---------------------------------------------------------------------------
+// Aligned log job - schedule the next, then log. If aligned logging was turned off, or the clock is no
+// longer set, logging goes back to the log timer.
+void sfeIoTNodeLoRaWAN::onLogAlignedJob(void)
+{
+    if (!alignedLogging() || !scheduleAlignedLog())
+    {
+        flxRemoveJobFromQueue(_logAlignedJob);
+        _logAlignedActive = false;
+
+        _timer.start();
+        _nextLogTicks = millis() + _timer.interval();
+    }
+    onLogInterval();
+}
+//---------------------------------------------------------------------------
+// Set the aligned log job to run at the next clock time that is a multiple of the log interval, plus the
+// device offset. Times are from the clock on each call, so the schedule doesn't drift with the time
+// taken by each log cycle. Returns false if the clock isn't set.
+//
+bool sfeIoTNodeLoRaWAN::scheduleAlignedLog(void)
+{
+    struct timeval tv;
+    if (gettimeofday(&tv, nullptr) != 0 || tv.tv_sec < kAlignedLogValidEpoch)
+        return false;
+
+    uint32_t interval = _timer.interval();
+    if (interval == 0)
+        return false;
+
+    uint32_t offset = deviceLogOffset() ? _loraWANConnection.deviceEUIHash() % interval : 0;
+
+    uint64_t nowMS = (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    uint32_t waitMS = interval - (uint32_t)((nowMS + interval - offset) % interval);
+
+    // just before a boundary - the job ran a little early. Skip to the following one
+    if (waitMS < kAlignedLogMinWaitMS && interval > kAlignedLogMinWaitMS)
+        waitMS += interval;
+
+    _logAlignedJob.setPeriod(waitMS);
+    if (_logAlignedActive)
+        flxUpdateJobInQueue(_logAlignedJob);
+    else
+        flxAddJobToQueue(_logAlignedJob);
+
+    _logAlignedActive = true;
+    _nextLogTicks = millis() + waitMS;
+
+    return true;
+}
+//---------------------------------------------------------------------------
+// A log interval - from the log timer or the aligned log job
+void sfeIoTNodeLoRaWAN::onLogInterval(void)
+{
+    // Battery saver - only log on every Nth interval
+    if (++_logIntervalsSkipped < _batteryPolicy.logDivisor())
+        return;
+
+    _logIntervalsSkipped = 0;
+
+    // jitter the log time - the aligned log has its own per device offset
+    if (logJitter() && !_logAlignedActive)
+    {
+        uint32_t maxJitter = _timer.interval() / kLogJitterIntervalDivisor;
+        scheduleLogJitter(maxJitter < kLogJitterIntervalMaxMS ? maxJitter : kLogJitterIntervalMaxMS);
+        return;
+    }
+    onLogEvent();
+}
+//---------------------------------------------------------------------------
+// Log after a random delay, up to the given time. The random sequence is seeded from the device EUI, so
+// boards started together are on different sequences.
+//
+void sfeIoTNodeLoRaWAN::scheduleLogJitter(uint32_t maxJitterMS)
+{
+    if (_logJitterState == 0)
+    {
+        _logJitterState = _loraWANConnection.deviceEUIHash();
+        if (_logJitterState == 0)
+            _logJitterState = rp2040.hwrand32() | 1;
+    }
+    // xorshift32
+    _logJitterState ^= _logJitterState << 13;
+    _logJitterState ^= _logJitterState >> 17;
+    _logJitterState ^= _logJitterState << 5;
+
+    uint32_t jitterMS = maxJitterMS > 0 ? _logJitterState % maxJitterMS : 0;
+    if (jitterMS == 0)
+    {
+        onLogEvent();
+        return;
+    }
+    _nextLogTicks = millis() + jitterMS;
+
+    flxRemoveJobFromQueue(_logJitterJob);
+    _logJitterJob.setPeriod(jitterMS);
+    flxAddJobToQueue(_logJitterJob);
 }
 //---------------------------------------------------------------------------
 // for qwiic button events
@@ -774,34 +1111,79 @@ void sfeIoTNodeLoRaWAN::onQwiicButtonEvent(bool bPressed)
 
 void sfeIoTNodeLoRaWAN::onLoRaWANSendEvent(bool bOkay)
 {
+    // stay awake for the receive windows that follow the transmit - for any downlink
+    _awakeUntilTicks = millis() + kLowPowerRxAwakeMS;
+
     if (bOkay)
         sfeLED.flash(sfeLED.Green);
     else
         sfeLED.flash(sfeLED.Red);
+
+    // first uplink since startup?
+    if (bOkay && _bootPhaseTicks[kBootPhaseUplink] == 0)
+    {
+        markBootPhase(kBootPhaseUplink);
+        if (get_verbose())
+            displayBootTimes();
+    }
+}
+
+//---------------------------------------------------------------------------
+// On the first connection to the LoRaWAN, trigger a log event - so data is sent right away
+void sfeIoTNodeLoRaWAN::onLoRaWANConnectionChange(bool bConnected)
+{
+    if (!bConnected)
+        return;
+
+    // a battery saver change made while not connected?
+    sendBatteryTier();
+
+    if (_hasConnected)
+        return;
+
+    _hasConnected = true;
+    markBootPhase(kBootPhaseConnected);
+
+    // boards started together join together - jitter the first log so they don't all send at once
+    if (logJitter())
+        scheduleLogJitter(kLogJitterFirstMaxMS);
+    else
+        _timer.trigger();
 }
 
 void sfeIoTNodeLoRaWAN::onSystemResetEvent(void)
 {
+    prepareRestart();
+
     // The system is being reset - reset our settings
     flxSettings.reset();
 }
 //---------------------------------------------------------------------------
+void sfeIoTNodeLoRaWAN::prepareRestart(void)
+{
+    // SD card data still in the write buffer
+    _sdWriteBuffer.flush();
+}
+//---------------------------------------------------------------------------
 void sfeIoTNodeLoRaWAN::onFirmwareLoad(bool bLoading)
 {
     if (bLoading)
+    {
+        // a firmware load restarts the device
+        prepareRestart();
         sfeLED.on(sfeLED.Yellow);
+    }
     else
         sfeLED.off();
 }
 
 //---------------------------------------------------------------------------
-// Callback for LoRaWAN receive events
-void sfeIoTNodeLoRaWAN::onLoRaWANReceiveEvent(uint32_t data)
+// Downlink handler for the on-board LED messages
+void sfeIoTNodeLoRaWAN::onLEDDownlink(uint8_t port, const uint8_t *payload, size_t len)
 {
-
-    // flxLog_I("LoRaWAN Received Event: 0x%0.8X", data);
-
-    uint8_t *pData = (uint8_t *)&data;
+    // The LED messages are up to 4 bytes - opcode and value. Short messages are zero filled
+    uint8_t pData[4] = {0};
+    memcpy(pData, payload, len < sizeof(pData) ? len : sizeof(pData));
 
     // We basically update/change the state of the on-board LED
     sfeLEDColor_t color;
@@ -834,6 +1216,54 @@ void sfeIoTNodeLoRaWAN::onLoRaWANReceiveEvent(uint32_t data)
     }
 }
 //---------------------------------------------------------------------------
+// Job stats - append the run and lateness stats of each job to a CSV file on the SD card
+//
+void sfeIoTNodeLoRaWAN::onJobStatsJob(void)
+{
+    if (!jobStatsToSD() || !_theSDCard.enabled())
+        return;
+
+    bool bNewFile = !_theSDCard.exists(kJobStatsFile);
+
+    flxFSFile theFile = _theSDCard.open(kJobStatsFile, flxIFileSystem::kFileAppend, true);
+    if (!theFile.isValid())
+    {
+        flxLog_W(F("Unable to open the job stats file %s"), kJobStatsFile);
+        return;
+    }
+
+    char szBuffer[160];
+    int len;
+    if (bNewFile)
+    {
+        len = snprintf(szBuffer, sizeof(szBuffer),
+                       "uptime_s,job,runs,total_ms,max_us,late_lt10ms,late_lt100ms,late_lt1s,late_lt10s,"
+                       "late_ge10s,max_late_ms,overruns\r\n");
+        theFile.write((uint8_t *)szBuffer, len);
+    }
+
+    uint32_t uptime = millis() / 1000;
+    for (flxJobMetrics *pMetrics = flxJobMetrics::first(); pMetrics != nullptr; pMetrics = pMetrics->next())
+    {
+        len = snprintf(szBuffer, sizeof(szBuffer), "%u,%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\r\n", uptime,
+                       pMetrics->name(), pMetrics->nRuns(), (uint32_t)(pMetrics->totalTime() / 1000),
+                       pMetrics->maxTime(), pMetrics->lateHistogram(0), pMetrics->lateHistogram(1),
+                       pMetrics->lateHistogram(2), pMetrics->lateHistogram(3), pMetrics->lateHistogram(4),
+                       pMetrics->maxLate(), pMetrics->nOverruns());
+        if (len > 0 && len < sizeof(szBuffer))
+            theFile.write((uint8_t *)szBuffer, len);
+    }
+    theFile.close();
+}
+//---------------------------------------------------------------------------
+// The battery job
+void sfeIoTNodeLoRaWAN::onBatteryJob(void)
+{
+    flxJobMetricsScope metrics(_metricsBattery, _batteryJob.get());
+
+    checkBatteryLevels();
+}
+//---------------------------------------------------------------------------
 // checkBatteryLevels()
 //
 // If a battery is attached, flash the led based on state of charge
@@ -848,7 +1278,18 @@ void sfeIoTNodeLoRaWAN::checkBatteryLevels(void)
     sfeLEDColor_t color;
 
     if (batterySOC > kBatteryNoBatterySOC) // no battery
+    {
+        updateBatteryPolicy(false, 0., 0.);
         return;
+    }
+    updateBatteryPolicy(batterySaver(), batterySOC, _fuelGauge->getChangeRate());
+
+    // low voltage alert off? Back on once the battery has recovered
+    if (_fuelGaugeVoltageAlertOff && _fuelGauge->getVoltage() > kFuelGaugeAlertVoltageRestore)
+    {
+        _fuelGauge->setVALRTMin(kFuelGaugeAlertVoltage);
+        _fuelGaugeVoltageAlertOff = false;
+    }
 
     if (batterySOC < 10.)
         color = sfeLED.Red;
@@ -860,6 +1301,123 @@ void sfeIoTNodeLoRaWAN::checkBatteryLevels(void)
     sfeLED.flash(color);
 }
 
+//---------------------------------------------------------------------------
+// Fuel gauge alerts - if the ALRT output is connected, the fuel gauge signals a 1% change in charge, a low
+// charge and a low voltage. The battery checks are made on these alerts, not polled.
+//
+bool sfeIoTNodeLoRaWAN::setupFuelGaugeAlert(void)
+{
+    if (!_fuelGauge || fuelGaugeAlertPin() == kFuelGaugeAlertPinNone)
+        return false;
+
+    _fuelGauge->enableSOCAlert();
+    _fuelGauge->setThreshold(kFuelGaugeAlertSOC);
+    _fuelGauge->setVALRTMin(kFuelGaugeAlertVoltage);
+    _fuelGauge->clearAlert();
+
+    // The alert is handled by the main loop - which is running this
+    hFuelGaugeAlertTask = xTaskGetCurrentTaskHandle();
+
+    // ALRT is open drain, active low
+    pinMode(fuelGaugeAlertPin(), INPUT_PULLUP);
+    attachInterrupt(fuelGaugeAlertPin(), fuelGaugeAlertISR, FALLING);
+
+    flxLog_I(F("Fuel gauge alerts enabled - pin %u"), fuelGaugeAlertPin());
+    return true;
+}
+//---------------------------------------------------------------------------
+void sfeIoTNodeLoRaWAN::onFuelGaugeAlert(void)
+{
+    if (!_fuelGauge)
+        return;
+
+    flxJobMetricsScope metrics(_metricsBattery);
+
+    // Read and clear the alert flags, then the alert - which releases the ALRT output
+    bool bLow = _fuelGauge->isLow(true);
+    bool bVoltageLow = _fuelGauge->isVoltageLow(true);
+    _fuelGauge->isChange(true);
+
+    // the low voltage alert sets again at each reading while the voltage is low - turn it off for now
+    if (bVoltageLow)
+    {
+        _fuelGauge->setVALRTMin(0);
+        _fuelGaugeVoltageAlertOff = true;
+    }
+    _fuelGauge->clearAlert();
+
+    if (bLow || bVoltageLow)
+        flxLog_W(F("Battery low - %.0f%% charge, %.2fV"), _fuelGauge->getSOC(), _fuelGauge->getVoltage());
+
+    checkBatteryLevels();
+}
+//---------------------------------------------------------------------------
+// Qwiic power gating - the rail is off between uses of the devices. Downlinks that read or set devices
+// wait on the power.
+void sfeIoTNodeLoRaWAN::setupQwiicPower(void)
+{
+    if (!qwiicPowerGating())
+        return;
+
+    // The clocks and buttons are on the rail - the time, and button events, would be lost when it's off
+    if (flux.get<flxDevRV8803>()->size() > 0 || flux.get<flxDevGNSS>()->size() > 0 ||
+        flux.get<flxDevButton>()->size() > 0)
+    {
+        flxLog_W(F("Qwiic power saving not available - a clock or button is connected"));
+        return;
+    }
+
+    // the devices are initialized at each power on - redo the app setup of them after that
+    _qwiicPower.setPowerOnAction([this]() { setupENS160(false); });
+    _qwiicPower.begin(qwiicWarmupTime());
+
+    auto gate = [this](std::function<void(void)> handlerCall) { _qwiicPower.run(handlerCall); };
+    _loraWANConnection.downlink().setPortGate(kLoRaWANRemoteConfigPort, gate);
+    _loraWANConnection.downlink().setPortGate(kLoRaWANReadPort, gate);
+}
+//---------------------------------------------------------------------------
+// Battery saver - update the policy tier from the battery charge, and apply it
+//
+void sfeIoTNodeLoRaWAN::updateBatteryPolicy(bool bEnabled, float batterySOC, float chargeRate)
+{
+    bool bChanged;
+    if (bEnabled)
+        bChanged = _batteryPolicy.update(batterySOC, chargeRate);
+    else
+    {
+        bChanged = _batteryPolicy.tier() != sfeNLBatteryPolicy::kTierNormal;
+        _batteryPolicy.reset();
+    }
+    if (!bChanged)
+        return;
+
+    _loraWANConnection.suspendHealth(!_batteryPolicy.sendHealth());
+
+    flxLog_I(F("Battery saver: %s (%.0f%% charge) - logging every %u intervals"), _batteryPolicy.tierName(),
+             batterySOC, _batteryPolicy.logDivisor());
+
+    // let the backend know - it explains the gaps in the data
+    _batteryTierPending = true;
+    _batteryTierSOC = batterySOC < 0. ? 0 : (batterySOC > 100. ? 100 : (uint8_t)batterySOC);
+    sendBatteryTier();
+}
+//---------------------------------------------------------------------------
+// Send the battery saver tier - payload: version, tier, charge (%), log divisor
+//
+void sfeIoTNodeLoRaWAN::sendBatteryTier(void)
+{
+    if (!_batteryTierPending || !_loraWANConnection.isConnected())
+        return;
+
+    uint8_t payload[] = {kLoRaWANBatteryTierVersion, (uint8_t)_batteryPolicy.tier(), _batteryTierSOC,
+                         _batteryPolicy.logDivisor()};
+
+    if (_loraWANConnection.sendMessage(kLoRaWANBatteryTierPort, payload, sizeof(payload)))
+        _batteryTierPending = false;
+    else
+        flxLog_D(F("Battery saver: unable to send the tier uplink"));
+}
+
 //---------------------------------------------------------------------------
 // Terminal Baud-rate things
 //---------------------------------------------------------------------------
@@ -916,6 +1474,16 @@ bool sfeIoTNodeLoRaWAN::get_verbose(void)
 
 bool sfeIoTNodeLoRaWAN::loop()
 {
+    // fuel gauge alert?
+    if (fuelGaugeAlert)
+    {
+        fuelGaugeAlert = false;
+        onFuelGaugeAlert();
+    }
+
+    // Any board button events queued by the button ISR?
+    _boardButton.processEvents();
+
     // key press at Serial Console? What to do??
     if (Serial.available())
     {
@@ -929,13 +1497,19 @@ bool sfeIoTNodeLoRaWAN::loop()
             Serial.write('!');
             Serial.flush();
             sfeNLCommands cmdProcessor;
+
+            // commands can use the devices - keep them powered
+            _qwiicPower.hold(true);
             bool status = cmdProcessor.processCommand(this);
+            _qwiicPower.hold(false);
         }
         else // edit settings
         {
             // start an editing session
             sfeLEDColor_t color;
+            _qwiicPower.hold(true);
             int status = _serialSettings.editSettings();
+            _qwiicPower.hold(false);
 
             if (status == -1)
             {
@@ -953,4 +1527,33 @@ bool sfeIoTNodeLoRaWAN::loop()
         }
     }
     return false;
+}
+
+//---------------------------------------------------------------------------
+// How long the main loop waits before the next pass - in ms. The wait ends early on a button event.
+//
+// In low power idle, the loop idles until the next log event - which lets the processor sleep in the
+// FreeRTOS idle task. It stays awake while joining, connected to USB (the console), and during a
+// transmit and its receive windows. Other jobs run when the loop wakes - at most kLowPowerMaxIdleMS late.
+//
+uint32_t sfeIoTNodeLoRaWAN::loopWaitTime(void)
+{
+    if (!lowPowerIdle() || tud_mounted())
+        return kAppLoopDelayMS;
+
+    flxLoRaWANDigi::joinState_t joinState = _loraWANConnection.joinState();
+    if (joinState != flxLoRaWANDigi::kJoinStateIdle && joinState != flxLoRaWANDigi::kJoinStateConnected &&
+        joinState != flxLoRaWANDigi::kJoinStateFailed)
+        return kAppLoopDelayMS;
+
+    uint32_t ticks = millis();
+    if ((int32_t)(_awakeUntilTicks - ticks) > 0)
+        return kAppLoopDelayMS;
+
+    // time to the next log event
+    int32_t waitTime = (int32_t)(_nextLogTicks - ticks);
+    if (waitTime <= (int32_t)kAppLoopDelayMS)
+        return kAppLoopDelayMS;
+
+    return (uint32_t)waitTime < kLowPowerMaxIdleMS ? (uint32_t)waitTime : kLowPowerMaxIdleMS;
 }
\ No newline at end of file
@@ -17,9 +17,16 @@
 #include <Flux/flxLogger.h>
 #include <Flux/flxTimer.h>
 
+#include "flxJobMetrics.h"
+#include "flxLoRaWANClockSync.h"
 #include "flxLoRaWANDigi.h"
+#include "flxLoRaWANFirmwareUpdate.h"
 #include "flxLoRaWANLogger.h"
+#include "flxLoRaWANRemoteConfig.h"
+#include "flxWriteBehind.h"
+#include "sfeNLBatteryPolicy.h"
 #include "sfeNLButton.h"
+#include "sfeNLQwiicPower.h"
 #include <Flux/flxDevMAX17048.h>
 #include <Flux/flxDevSoilMoisture.h>
 #include <Flux/flxFSSDCard.h>
@@ -46,6 +53,10 @@ const uint32_t kStartupMenuDefaultDelaySecs = 2;
 // Battery check interval (90 seconds)
 const uint32_t kBatteryCheckInterval = 90000;
 
+// Battery check interval when the fuel gauge alert pin is used (30 minutes) - a sanity check, the alerts
+// drive the battery checks
+const uint32_t kBatteryCheckIntervalAlert = 1800000;
+
 // Operation mode flags
 #define kAppOpNone (0)
 #define kAppOpEditing (1 << 0)
@@ -131,12 +142,21 @@ class sfeIoTNodeLoRaWAN : public flxApplication
     // event callback for system reset
     void onSystemResetEvent(void);
 
+    // Called before any restart or reset of the device - saves data not yet written
+    void prepareRestart(void);
+
     void onErrorMessage(uint8_t);
     void onLogEvent(void);
+    void onLogTimer(void);
+    void onLogAlignedJob(void);
+    void onLogInterval(void);
+    bool scheduleAlignedLog(void);
+    void scheduleLogJitter(uint32_t maxJitterMS);
     void onQwiicButtonEvent(bool);
     void onFirmwareLoad(bool bLoading);
     void onLoRaWANSendEvent(bool);
-    void onLoRaWANReceiveEvent(uint32_t);
+    void onLEDDownlink(uint8_t, const uint8_t *, size_t);
+    void onLoRaWANConnectionChange(bool);
 
     // support for onInit
     void onInitStartupCommands(uint32_t);
@@ -154,6 +174,15 @@ class sfeIoTNodeLoRaWAN : public flxApplication
 
     bool loop();
 
+    // How long the main loop should wait before the next pass - in ms
+    uint32_t loopWaitTime(void);
+
+    // Run time of the main loop passes - all time the board is awake
+    flxJobMetrics &loopMetrics(void)
+    {
+        return _loopMetrics;
+    }
+
     // Color Text Output
     flxPropertyRWBool<sfeIoTNodeLoRaWAN, &sfeIoTNodeLoRaWAN::get_color_text, &sfeIoTNodeLoRaWAN::set_color_text>
         colorTextOutput = {true};
@@ -200,6 +229,30 @@ class sfeIoTNodeLoRaWAN : public flxApplication
     flxPropertyRWBool<sfeIoTNodeLoRaWAN, &sfeIoTNodeLoRaWAN::get_soil_enabled, &sfeIoTNodeLoRaWAN::set_soil_enabled>
         enableSoilSensor = {false};
 
+    // Idle the main loop between log events - when not connected to USB
+    flxPropertyBool<sfeIoTNodeLoRaWAN> lowPowerIdle = {false};
+
+    // Log at clock time multiples of the log interval - and offset that time by a per device amount
+    flxPropertyBool<sfeIoTNodeLoRaWAN> alignedLogging = {false};
+    flxPropertyBool<sfeIoTNodeLoRaWAN> deviceLogOffset = {false};
+
+    // Add a random delay to log events - so boards started together don't send at the same time
+    flxPropertyBool<sfeIoTNodeLoRaWAN> logJitter = {false};
+
+    // Write the job run and lateness stats to the SD card - hourly
+    flxPropertyBool<sfeIoTNodeLoRaWAN> jobStatsToSD = {false};
+
+    // Log less often as the battery drains
+    flxPropertyBool<sfeIoTNodeLoRaWAN> batterySaver = {false};
+
+    // GPIO connected to the fuel gauge ALRT output - kFuelGaugeAlertPinNone if not connected
+    static constexpr uint8_t kFuelGaugeAlertPinNone = 255;
+    flxPropertyUInt8<sfeIoTNodeLoRaWAN> fuelGaugeAlertPin = {kFuelGaugeAlertPinNone};
+
+    // Power the Qwiic rail only when devices are used - and the time (ms) devices need after power on
+    flxPropertyBool<sfeIoTNodeLoRaWAN> qwiicPowerGating = {false};
+    flxPropertyUInt32<sfeIoTNodeLoRaWAN> qwiicWarmupTime = {0, 5000};
+
   private:
     friend class sfeNLCommands;
     void _displayAboutObjHelper(char, const char *, bool);
@@ -207,6 +260,23 @@ class sfeIoTNodeLoRaWAN : public flxApplication
     void displayAppStatus(bool useInfo = false);
 
     void getStartupProperties(uint32_t &baudRate, uint32_t &startupDelay);
+    bool getStartupLoRaWANJoin(uint32_t &baudRate);
+
+    // Boot phases - marked at startup for the boot timing report
+    typedef enum
+    {
+        kBootPhaseInit = 0,
+        kBootPhaseSetup,
+        kBootPhaseDeviceLoad,
+        kBootPhaseStart,
+        kBootPhaseStarted,
+        kBootPhaseConnected,
+        kBootPhaseUplink,
+        kBootPhaseCount
+    } bootPhase_t;
+
+    void markBootPhase(bootPhase_t phase);
+    void displayBootTimes(void);
 
     // Board button callbacks
     void onButtonPressed(uint32_t);
@@ -217,10 +287,21 @@ class sfeIoTNodeLoRaWAN : public flxApplication
 
     // battery level checks
     void checkBatteryLevels(void);
+    void onBatteryJob(void);
+
+    // job stats to the SD card
+    void onJobStatsJob(void);
+    void updateBatteryPolicy(bool bEnabled, float batterySOC, float chargeRate);
+    void sendBatteryTier(void);
+    bool setupFuelGaugeAlert(void);
+    void onFuelGaugeAlert(void);
+
+    // Qwiic rail power gating
+    void setupQwiicPower(void);
 
     // setup routines
     bool setupTime();
-    void setupENS160(void);
+    void setupENS160(bool bStartup = true);
     bool setupSDCard(void);
     bool checkOnBoardFS(void);
 
@@ -228,6 +309,15 @@ class sfeIoTNodeLoRaWAN : public flxApplication
     flxLoRaWANDigi _loraWANConnection;
     flxLoRaWANLogger _loraWANLogger;
 
+    // Remote configuration of properties via downlinks
+    flxLoRaWANRemoteConfig _remoteConfig;
+
+    // Firmware updates via LoRaWAN
+    flxLoRaWANFirmwareUpdate _loraWANUpdate;
+
+    // Network time via LoRaWAN
+    flxLoRaWANClockSync _loraWANTime;
+
     // Our logger
     flxLogger _logger;
 
@@ -241,6 +331,7 @@ class sfeIoTNodeLoRaWAN : public flxApplication
 
     flxFSSDCard _theSDCard;
     flxFileRotate _theOutputFile;
+    flxWriteBehind _sdWriteBuffer;
     flxStorageJSONPrefFile _jsonStorage;
 
     // Serial Settings editor
@@ -253,8 +344,9 @@ class sfeIoTNodeLoRaWAN : public flxApplication
     // Our system Control
     flxSystem _sysSystem;
 
-    // Fuel gauge
+    // Fuel gauge - and is its low voltage alert off, after it fired?
     flxDevMAX17048 *_fuelGauge;
+    bool _fuelGaugeVoltageAlertOff = false;
 
     // The soil moisture device object -- if a user connects it to the GPIO of the device.
     flxDevSoilMoisture _soilSensor;
@@ -268,8 +360,42 @@ class sfeIoTNodeLoRaWAN : public flxApplication
     // battery check event
     std::unique_ptr<flxJob> _batteryJob;
 
+    // battery saver - the current tier, and log intervals skipped in the tier
+    sfeNLBatteryPolicy _batteryPolicy;
+
+    // Battery saver tier change not yet sent - and the charge at the change
+    bool _batteryTierPending = false;
+    uint8_t _batteryTierSOC = 0;
+    uint8_t _logIntervalsSkipped;
+
     uint32_t _opFlags;
 
     // flag for the on-board flash file system (RP2350)
     bool _hasOnBoardFlashFS = false;
+
+    // has the LoRaWAN connected since startup?
+    bool _hasConnected = false;
+
+    // low power idle - when the next log is due, and the loop stays awake until (millis())
+    uint32_t _nextLogTicks;
+    uint32_t _awakeUntilTicks;
+
+    // Aligned logging - the job for the log events, used once the clock is set
+    flxJob _logAlignedJob;
+    bool _logAlignedActive = false;
+
+    // Writes the job stats to the SD card
+    flxJob _jobStatsJob;
+
+    // Log jitter - a one shot job for the delayed log event, and the random sequence state
+    flxJob _logJitterJob;
+    uint32_t _logJitterState = 0;
+
+    flxJobMetrics _loopMetrics = {"Main Loop"};
+
+    // Qwiic power gating - powers the Qwiic rail when devices are used
+    sfeNLQwiicPower _qwiicPower;
+
+    // millis() since power on when each boot phase was reached - 0 if not reached
+    uint32_t _bootPhaseTicks[kBootPhaseCount] = {0};
 };
\ No newline at end of file
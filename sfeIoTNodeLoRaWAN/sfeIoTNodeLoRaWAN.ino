@@ -9,6 +9,8 @@
  *---------------------------------------------------------------------------------
  */
 #include <Arduino.h>
+#include <FreeRTOS.h>
+#include <task.h>
 
 #include "sfeIoTNodeLoRaWAN.h"
 #include "sfeNLLed.h"
@@ -27,9 +29,13 @@ void setup()
 
 void loop()
 {
-    // Run the framework
-    if (flux.loop())
-        sfeLED.flash(sfeLED.Blue);
-
-    delay(10);
+    // Run the framework - timed for the power use estimate
+    {
+        flxJobMetricsScope metrics(theNodeLoRaWAN.loopMetrics());
+        if (flux.loop())
+            sfeLED.flash(sfeLED.Blue);
+    }
+
+    // Wait for the next pass - a button event wakes the loop early
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(theNodeLoRaWAN.loopWaitTime()));
 }
\ No newline at end of file
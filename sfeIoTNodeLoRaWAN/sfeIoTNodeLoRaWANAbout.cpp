@@ -83,7 +83,8 @@ void sfeIoTNodeLoRaWAN::displayAppStatus(bool useInfo)
         flxSerial.textToNormal();
     }
 
-    flxLog__(logLevel, "%cStatus: %s", pre_ch, _loraWANConnection.isConnected() ? "Connected" : "Disconnected");
+    flxLog__(logLevel, "%cStatus: %s", pre_ch,
+             _loraWANConnection.isConnected() ? "Connected" : _loraWANConnection.joinStateName());
 
     flxLog__(logLevel, "%cDevice EUI: %s", pre_ch, _loraWANConnection.deviceEUI());
     flxLog__(logLevel, "%cApplication EUI: %s", pre_ch, _loraWANConnection.appEUI().c_str());
@@ -214,6 +215,8 @@ void sfeIoTNodeLoRaWAN::displayAppStatus(bool useInfo)
         flxLog_N("%c    Current Filename: \t%s", pre_ch,
                  _theOutputFile.currentFilename().length() == 0 ? "<none>" : _theOutputFile.currentFilename().c_str());
     flxLog_N("%c    Rotate Period: %d Hours", pre_ch, _theOutputFile.rotatePeriod());
+    flxLog_N("%c    Write Buffer: %dB, Flush Time: %d Secs", pre_ch, (int)flxWriteBehind::kBufferSize,
+             _sdWriteBuffer.flushTime());
 
     flxLog_N("");
 
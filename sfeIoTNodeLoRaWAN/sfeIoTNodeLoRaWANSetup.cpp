@@ -52,6 +52,11 @@ bool sfeIoTNodeLoRaWAN::setupTime()
         flxClock.addConnectedClock(rtc8803);
     }
 
+    // Network time via LoRaWAN - the reference clock if there's no hardware clock
+    flxClock.addReferenceClock(&_loraWANTime, _loraWANTime.name());
+    if (allGNSS->size() == 0 && allRTC8803->size() == 0)
+        refClock = _loraWANTime.name();
+
     // Now that clocks are loaded, set the ref clock to what was started with.
     flxClock.referenceClock = refClock;
 
@@ -62,7 +67,7 @@ bool sfeIoTNodeLoRaWAN::setupTime()
 }
 
 //---------------------------------------------------------------------------
-void sfeIoTNodeLoRaWAN::setupENS160(void)
+void sfeIoTNodeLoRaWAN::setupENS160(bool bStartup)
 {
 
     // do we have one attached?
@@ -80,7 +85,8 @@ void sfeIoTNodeLoRaWAN::setupENS160(void)
         pENS160->setTemperatureCompParameter(pBME->temperatureC);
         pENS160->setHumidityCompParameter(pBME->humidity);
 
-        flxLog_I(F("%s: compensation values applied from %s"), pENS160->name(), pBME->name());
+        if (bStartup)
+            flxLog_I(F("%s: compensation values applied from %s"), pENS160->name(), pBME->name());
         return;
     }
     // do we have a SHTC3 attached
@@ -92,7 +98,8 @@ void sfeIoTNodeLoRaWAN::setupENS160(void)
         pENS160->setTemperatureCompParameter(pSHTC3->temperatureC);
         pENS160->setHumidityCompParameter(pSHTC3->humidity);
 
-        flxLog_I(F("%s: compensation values applied from %s"), pENS160->name(), pSHTC3->name());
+        if (bStartup)
+            flxLog_I(F("%s: compensation values applied from %s"), pENS160->name(), pSHTC3->name());
         return;
     }
 }
@@ -119,6 +126,9 @@ bool sfeIoTNodeLoRaWAN::setupSDCard(void)
         _theOutputFile.startNumber = 1;
         _theOutputFile.rotatePeriod(24); // one day
 
+        // log output is buffered, and written to the file in card sectors
+        _sdWriteBuffer.setTarget(_theOutputFile);
+
         // add the file output to the CSV output.
         //_fmtCSV.add(_theOutputFile);
 
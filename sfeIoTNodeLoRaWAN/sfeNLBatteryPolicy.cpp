@@ -0,0 +1,57 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "sfeNLBatteryPolicy.h"
+
+// Per tier - state of charge (%) below which the tier is entered, and at/above which it is left
+static const float kTierEnterSOC[sfeNLBatteryPolicy::kTierCount] = {0., 40., 20., 10.};
+static const float kTierExitSOC[sfeNLBatteryPolicy::kTierCount] = {0., 50., 30., 15.};
+
+// Log on every Nth log interval - per tier
+static const uint8_t kTierLogDivisor[sfeNLBatteryPolicy::kTierCount] = {1, 2, 4, 8};
+
+static const char *kTierNames[sfeNLBatteryPolicy::kTierCount] = {"Normal", "Conserve", "Low", "Critical"};
+
+// Charge rate (%/hr) above which the battery is charging
+const float kChargingRate = 0.5;
+
+//----------------------------------------------------------------
+bool sfeNLBatteryPolicy::update(float soc, float chargeRate)
+{
+    tier_t newTier = _tier;
+
+    if (chargeRate > kChargingRate)
+        newTier = kTierNormal;
+    else
+    {
+        // drop to the lowest tier the charge is below, then back up past any tier the charge has left
+        while (newTier < kTierCritical && soc < kTierEnterSOC[newTier + 1])
+            newTier = (tier_t)(newTier + 1);
+
+        while (newTier > kTierNormal && soc >= kTierExitSOC[newTier])
+            newTier = (tier_t)(newTier - 1);
+    }
+
+    if (newTier == _tier)
+        return false;
+
+    _tier = newTier;
+    return true;
+}
+//----------------------------------------------------------------
+const char *sfeNLBatteryPolicy::tierName(void) const
+{
+    return kTierNames[_tier];
+}
+//----------------------------------------------------------------
+uint8_t sfeNLBatteryPolicy::logDivisor(void) const
+{
+    return kTierLogDivisor[_tier];
+}
@@ -0,0 +1,66 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Battery saver policy - maps the battery state of charge to how often data is logged and sent, so a
+// board on a draining battery sends less often instead of stopping without warning.
+//
+// Each tier is entered when the charge drops below its entry level, and left once the charge rises
+// above a higher exit level - the gap keeps the policy from flipping on a noisy reading. A charging
+// battery uses the normal tier.
+//
+// Portable - no Arduino or flux dependencies.
+
+#include <cstdint>
+
+class sfeNLBatteryPolicy
+{
+  public:
+    typedef enum
+    {
+        kTierNormal = 0,
+        kTierConserve,
+        kTierLow,
+        kTierCritical,
+        kTierCount
+    } tier_t;
+
+    sfeNLBatteryPolicy() : _tier{kTierNormal}
+    {
+    }
+
+    // Update from a fuel gauge reading - state of charge (%) and charge rate (%/hr). Returns true if the
+    // tier changed.
+    bool update(float soc, float chargeRate);
+
+    void reset(void)
+    {
+        _tier = kTierNormal;
+    }
+
+    tier_t tier(void) const
+    {
+        return _tier;
+    }
+    const char *tierName(void) const;
+
+    // Log on every Nth log interval
+    uint8_t logDivisor(void) const;
+
+    // Send non-critical uplinks (the link health)?
+    bool sendHealth(void) const
+    {
+        return _tier < kTierLow;
+    }
+
+  private:
+    tier_t _tier;
+};
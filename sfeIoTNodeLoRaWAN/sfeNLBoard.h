@@ -16,8 +16,8 @@
 // Das User button
 const uint8_t kNLBoardUserButton = 24;
 
-// 3v3 pin
-// const uint8_t kNLBoardEn3v3_SW = 32;
+// 3v3 pin - enable of the switched 3v3 (Qwiic) rail
+const uint8_t kNLBoardEn3v3_SW = 32;
 
 // SD Card CS Ping
 const uint8_t kNLBoardSDCardCSPin = 13;
@@ -27,3 +27,9 @@ const uint8_t kNLBoardLEDBuiltin = 25;
 
 // RGB LED
 const uint8_t kNLBoardLEDRGBBuiltin = 25;
+
+// Power use estimate - typical board current (mA) when awake (processor running), idle (processor
+// waiting, radio module listening) and during a LoRaWAN transmit. Values for an estimate only.
+const float kNLBoardCurrentAwake = 28.0;
+const float kNLBoardCurrentIdle = 12.0;
+const float kNLBoardCurrentTx = 120.0;
@@ -9,59 +9,70 @@
  */
 
 #include "sfeNLButton.h"
+#include "flxJobMetrics.h"
 #include "sfeNLBoard.h"
 
+#include <FreeRTOS.h>
+#include <atomic>
+#include <task.h>
+
 // What Defines momentary press?
 const uint16_t kMomentaryPress = 1001;
 
+// Edges closer than this to the last accepted edge are contact bounce - in ms
+const uint32_t kButtonDebounceTime = 25;
+
 // Button Event Types ...
 const uint8_t kEventNone = 0;
 const uint8_t kEventButtonPress = 1;
 const uint8_t kEventButtonRelease = 2;
 
 // --------------------------------------------------------------------------------
-// Define a simple queue for button events - if button events happen quickly, this helps
-// capture the changes.
+// Button events are passed from the ISR (the single producer) to the main loop (the single consumer)
+// via a lock-free ring. The ISR only writes the tail, the consumer only writes the head.
 
-// Define a button event type  and create a queue array
-const uint8_t kEventQueueSize = 4;
+// Define a button event type and the ring - the size must be a power of 2
+const uint8_t kEventQueueSize = 16;
 typedef struct buttonEvent
 {
     uint32_t ticks;      // ticks when the event happened
     uint8_t buttonEvent; // event type
 } buttonEvent_t;
 
-// The queue
 static buttonEvent_t buttonEventQueue[kEventQueueSize];
+static std::atomic<uint8_t> buttonEventQueueHead{0};
+static std::atomic<uint8_t> buttonEventQueueTail{0};
+
+// ISR debounce state - the last accepted event
+static uint8_t buttonLastEvent = kEventButtonRelease;
+static uint32_t buttonLastEventTicks = 0;
+
+// The task woken when an event is queued - the main loop
+static TaskHandle_t hButtonTask = NULL;
 
-// used to manage the queue
-static int8_t buttonEventQueueHead = 0;
-static int8_t buttonEventQueueTail = -1;
-static int8_t buttonEventQueueCount = 0;
+// Run time accounting - of event processing and the press increment job
+static flxJobMetrics _metricsButton("Button");
 
 // --------------------------------------------------------------------------------
-/// Add an event to the queue
+/// Add an event to the queue - called from the ISR
 /// @param eventType - the event type
-/// @retval true if added, false if not
+/// @param ticks - when the event happened
+/// @retval true if added, false if the queue is full
 ///
-static bool buttonEventEnqueue(uint8_t eventType)
+static bool buttonEventEnqueue(uint8_t eventType, uint32_t ticks)
 {
-    // Same event type as added last time? Just update the time
-    if (buttonEventQueueTail != -1 && buttonEventQueue[buttonEventQueueTail].buttonEvent == eventType)
-    {
-        buttonEventQueue[buttonEventQueueTail].ticks = millis();
-        return true;
-    }
-    // space in the queue?
-    if (buttonEventQueueCount < kEventQueueSize)
-    {
-        buttonEventQueueTail = (buttonEventQueueTail + 1) % kEventQueueSize;
-        buttonEventQueue[buttonEventQueueTail].ticks = millis();
-        buttonEventQueue[buttonEventQueueTail].buttonEvent = eventType;
-        buttonEventQueueCount++;
-        return true;
-    }
-    return false;
+    uint8_t tail = buttonEventQueueTail.load(std::memory_order_relaxed);
+    uint8_t next = (tail + 1) & (kEventQueueSize - 1);
+
+    // full?
+    if (next == buttonEventQueueHead.load(std::memory_order_acquire))
+        return false;
+
+    buttonEventQueue[tail].ticks = ticks;
+    buttonEventQueue[tail].buttonEvent = eventType;
+    buttonEventQueueTail.store(next, std::memory_order_release);
+
+    return true;
 }
 
 // --------------------------------------------------------------------------------
@@ -71,25 +82,38 @@ static bool buttonEventEnqueue(uint8_t eventType)
 ///
 static bool buttonEventDequeue(buttonEvent_t &event)
 {
+    uint8_t head = buttonEventQueueHead.load(std::memory_order_relaxed);
 
     //  Any events?
-    if (buttonEventQueueCount > 0)
-    {
-        event = buttonEventQueue[buttonEventQueueHead];
-        buttonEventQueue[buttonEventQueueHead].buttonEvent = kEventNone;
-        buttonEventQueueHead = (buttonEventQueueHead + 1) % kEventQueueSize;
-        buttonEventQueueCount--;
-        return true;
-    }
-    return false;
+    if (head == buttonEventQueueTail.load(std::memory_order_acquire))
+        return false;
+
+    event = buttonEventQueue[head];
+    buttonEventQueueHead.store((head + 1) & (kEventQueueSize - 1), std::memory_order_release);
+    return true;
 }
 //---------------------------------------------------------------------------
 // for the button ISR
 
 static void userButtonISR(void)
 {
-    // Add our event to our queue
-    buttonEventEnqueue(digitalRead(kNLBoardUserButton) == HIGH ? kEventButtonRelease : kEventButtonPress);
+    uint32_t ticks = millis();
+    uint8_t eventType = digitalRead(kNLBoardUserButton) == HIGH ? kEventButtonRelease : kEventButtonPress;
+
+    // Debounce - drop repeats of the last event, and edges within the bounce time of the last event
+    if (eventType == buttonLastEvent || ticks - buttonLastEventTicks < kButtonDebounceTime)
+        return;
+
+    buttonLastEvent = eventType;
+    buttonLastEventTicks = ticks;
+
+    if (!buttonEventEnqueue(eventType, ticks) || hButtonTask == NULL)
+        return;
+
+    // wake up the main loop to process the event
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(hButtonTask, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 //---------------------------------------------------------------------------
@@ -97,65 +121,89 @@ static void userButtonISR(void)
 //
 bool sfeNLButton::initialize(void)
 {
-    // setup our event handler
+    // The task to wake on button events - the main loop, which is running this
+    hButtonTask = xTaskGetCurrentTaskHandle();
+
+    // initialize our button event queue
+    buttonEventQueueHead = 0;
+    buttonEventQueueTail = 0;
+
+    // job for increment events while the button is held down - only queued when pressed
+    _jobPressIncrement.setup("buttonpress", _pressIncrement * 1000, this, &sfeNLButton::pressIncrement);
+
     // setup the button
     pinMode(kNLBoardUserButton, INPUT_PULLUP);
     attachInterrupt(kNLBoardUserButton, userButtonISR, CHANGE);
 
-    // job/timer for when we should check button state
-    _jobCheckButton.setup("buttoncheck", 200, this, &sfeNLButton::checkButton);
-    flxAddJobToQueue(_jobCheckButton);
-
-    // initialize our button event queue
-    buttonEventQueueHead = 0;
-    buttonEventQueueTail = -1;
-    buttonEventQueueCount = 0;
     return true;
 }
 
 //---------------------------------------------------------------------------
-// Callback for the job-queue to check the button state
+// Process the button events queued by the ISR - called from the main loop
 //
-void sfeNLButton::checkButton(void)
+void sfeNLButton::processEvents(void)
 {
-    // Button events are queued up in the ISR
-    if (buttonEventQueueCount > 0)
+    // Anything to do? This is called every loop pass
+    if (buttonEventQueueHead.load(std::memory_order_relaxed) ==
+        buttonEventQueueTail.load(std::memory_order_acquire))
+        return;
+
+    flxJobMetricsScope metrics(_metricsButton);
+
+    buttonEvent_t event;
+    while (buttonEventDequeue(event))
     {
-        buttonEvent_t event;
-        while (buttonEventDequeue(event))
+        // Drain all events out of the event queue
+        if (event.buttonEvent == kEventButtonPress)
         {
-            // Drain all events out of the event queue
-            if (event.buttonEvent == kEventButtonPress)
-            {
-                // press event - reset our increment counter and set the press ticks
-                _currentInc = 0;
-                _incEventTime = event.ticks;
-                _pressEventTime = event.ticks;
-
-                _userButtonPressed = true;
-
-                on_buttonPressed.emit(0); // event a pressed event - increment 0
-            }
-            else if (event.buttonEvent == kEventButtonRelease)
-            {
-                // button released - if tick delta from start is small, it's a momentary press
-                _userButtonPressed = false;
-                if (event.ticks - _pressEventTime < kMomentaryPress)
-                    on_momentaryPress.emit();
-                else // else, it's a release event
-                    on_buttonRelease.emit(_currentInc);
-            }
+            // press event - reset our increment counter and set the press ticks
+            _currentInc = 0;
+            _pressEventTime = event.ticks;
+
+            _userButtonPressed = true;
+
+            // increment events while the button is down
+            _jobPressIncrement.setPeriod(_pressIncrement * 1000);
+            flxAddJobToQueue(_jobPressIncrement);
+
+            on_buttonPressed.emit(0); // event a pressed event - increment 0
         }
-    }
-    // Is the button pressed ?
-    else if (_userButtonPressed)
-    {
-        // go over the increment time?
-        if ((millis() - _incEventTime) / 1000 >= _pressIncrement)
+        else if (event.buttonEvent == kEventButtonRelease)
         {
-            _currentInc++;
-            on_buttonPressed.emit(_currentInc);
-            _incEventTime = millis();
+            buttonReleased(event.ticks);
         }
     }
 }
+
+//---------------------------------------------------------------------------
+void sfeNLButton::buttonReleased(uint32_t ticks)
+{
+    flxRemoveJobFromQueue(_jobPressIncrement);
+
+    if (!_userButtonPressed)
+        return;
+
+    // button released - if tick delta from start is small, it's a momentary press
+    _userButtonPressed = false;
+    if (ticks - _pressEventTime < kMomentaryPress)
+        on_momentaryPress.emit();
+    else // else, it's a release event
+        on_buttonRelease.emit(_currentInc);
+}
+
+//---------------------------------------------------------------------------
+// Job callback - the button is still down after another increment period
+//
+void sfeNLButton::pressIncrement(void)
+{
+    flxJobMetricsScope metrics(_metricsButton, _jobPressIncrement);
+
+    // A release lost in the debounce time? The button is up
+    if (digitalRead(kNLBoardUserButton) == HIGH)
+    {
+        buttonReleased(millis());
+        return;
+    }
+    _currentInc++;
+    on_buttonPressed.emit(_currentInc);
+}
@@ -18,6 +18,8 @@
 //
 // Note: For button press events, the class will send out "increment" events if the button is pressed for a
 // longer that "momentary" period
+//
+// Button changes are debounced and queued by the pin ISR, which wakes the main loop - that calls processEvents().
 
 class sfeNLButton : public flxActionType<sfeNLButton>
 {
@@ -31,6 +33,9 @@ class sfeNLButton : public flxActionType<sfeNLButton>
 
     bool initialize(void);
 
+    // Process queued button events - called from the application loop
+    void processEvents(void);
+
     // An Pressed event is sent after each increment value.
     void setPressIncrement(uint inc)
     {
@@ -44,7 +49,9 @@ class sfeNLButton : public flxActionType<sfeNLButton>
     flxSignalUInt32 on_buttonPressed;
 
   private:
-    void checkButton(void);
+    void pressIncrement(void);
+    void buttonReleased(uint32_t ticks);
+
     // How many seconds per increment on a button press
     uint32_t _pressIncrement;
 
@@ -54,11 +61,8 @@ class sfeNLButton : public flxActionType<sfeNLButton>
     // ticks when the button was pressed
     uint32_t _pressEventTime;
 
-    // Ticks since last increment event
-    uint32_t _incEventTime;
-
     // the current increment count
     uint16_t _currentInc;
 
-    flxJob _jobCheckButton;
+    flxJob _jobPressIncrement;
 };
\ No newline at end of file
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "sfeIoTNodeLoRaWAN.h"
+#include "sfeNLBoard.h"
 #include <ArduinoJson.h>
 #include <Flux/flxCoreLog.h>
 
@@ -33,6 +34,7 @@ class sfeNLCommands
         if (!theApp)
             return false;
 
+        theApp->prepareRestart();
         theApp->_sysSystem.resetDevicePrompt();
 
         // should never get here
@@ -44,6 +46,7 @@ class sfeNLCommands
         if (!theApp)
             return false;
 
+        theApp->prepareRestart();
         theApp->_sysSystem.resetDevice();
 
         return true;
@@ -84,7 +87,10 @@ class sfeNLCommands
     bool restartDevice(sfeIoTNodeLoRaWAN *theApp)
     {
         if (theApp)
+        {
+            theApp->prepareRestart();
             theApp->_sysSystem.restartDevicePrompt();
+        }
 
         return true;
     }
@@ -93,7 +99,10 @@ class sfeNLCommands
     {
 
         if (theApp)
+        {
+            theApp->prepareRestart();
             theApp->_sysSystem.restartDevice();
+        }
 
         return true;
     }
@@ -411,11 +420,173 @@ class sfeNLCommands
         if (!theApp)
             return false;
         flxLog_I("LoRaWAN Status: '%s'", theApp->_loraWANConnection.isConnected() ? "Connected" : "Disconnected");
+        flxLog_I("Join State: %s", theApp->_loraWANConnection.joinStateName());
         flxLog_I("Device EUI: %s", theApp->_loraWANConnection.deviceEUI());
         flxLog_I("Application EUI: %s", theApp->_loraWANConnection.appEUI().c_str());
         flxLog_I("Operating Class: '%s'",
                  theApp->_loraWANConnection.kLoRaWANClasses[theApp->_loraWANConnection.loraWANClass()]);
         flxLog_I("Operating Region: '%s'", theApp->_loraWANConnection.getRegionName());
+        std::string theMask = theApp->_loraWANConnection.channelMask();
+        if (theMask.size() > 0)
+            flxLog_I("Channel Mask: %s", theMask.c_str());
+        flxLog_I("Joins: %u, last join: %u ms, %u attempts", theApp->_loraWANConnection.joinCount(),
+                 theApp->_loraWANConnection.lastJoinTime(), theApp->_loraWANConnection.lastJoinAttempts());
+        flxLog_I("Module Configuration: 0x%08X", theApp->_loraWANConnection.moduleConfigFingerprint());
+        flxLog_I("Module UART Rate: %u bps", theApp->_loraWANConnection.moduleUARTRate());
+        flxLog_I("Network Time Syncs: %u, last correction: %d secs, uplink time: %u ms",
+                 theApp->_loraWANTime.syncCount(), theApp->_loraWANTime.lastCorrection(),
+                 theApp->_loraWANTime.lastUplinkTime());
+
+        // link statistics
+        const flxLoRaWANLinkStats &stats = theApp->_loraWANConnection.linkStats();
+        flxLog_I("Transmits: %u, failed: %u, success rate: %.1f%%, most failed in a row: %u", stats.nTx(),
+                 stats.nTxFailed(), stats.txSuccessRate() * 100., stats.txFailRunMax());
+        if (stats.nSignal() > 0)
+            flxLog_I("Signal: RSSI %.1f dBm, SNR %.1f dB (%u samples)", stats.rssi(), stats.snr(), stats.nSignal());
+
+        if (stats.nDownlinks() == 0)
+            flxLog_I("Downlinks: 0");
+        else
+            flxLog_I("Downlinks: %u, counter: %u, last: %u secs ago", stats.nDownlinks(), stats.downlinkCounter(),
+                     stats.timeSinceDownlink(millis()) / 1000);
+
+        if (stats.nSignal() > 0)
+        {
+            flxLog_N_(F("    RSSI Histogram (dBm):"));
+            for (int i = 0; i < flxLoRaWANLinkStats::kRSSIBins; i++)
+                flxLog_N_(F("  %s%d: %u"), i == 0 ? "<" : "", flxLoRaWANLinkStats::kRSSIBinStart +
+                          (i == 0 ? 1 : i) * flxLoRaWANLinkStats::kRSSIBinWidth, stats.rssiHistogram(i));
+            flxLog_N("");
+
+            flxLog_N_(F("    SNR Histogram (dB):"));
+            for (int i = 0; i < flxLoRaWANLinkStats::kSNRBins; i++)
+                flxLog_N_(F("  %s%d: %u"), i == 0 ? "<" : "", flxLoRaWANLinkStats::kSNRBinStart +
+                          (i == 0 ? 1 : i) * flxLoRaWANLinkStats::kSNRBinWidth, stats.snrHistogram(i));
+            flxLog_N("");
+        }
+
+        // devices for read requests - by index
+        flxLog_N_(F("    Read Request Devices:"));
+        uint8_t index = 0;
+        for (auto pDevice : theApp->_loraWANLogger.devices())
+            flxLog_N_(F("  %u: %s"), index++, pDevice->name());
+        flxLog_N("");
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    ///
+    /// @brief output the boot phase timing
+    ///
+    /// @param theApp Pointer to the DataLogger App
+    /// @retval bool indicates success (true) or failure (!true)
+    ///
+    bool bootTimes(sfeIoTNodeLoRaWAN *theApp)
+    {
+        if (!theApp)
+            return false;
+
+        theApp->displayBootTimes();
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    ///
+    /// @brief output the job run time accounting, and an estimate of the power use
+    ///
+    /// @param theApp Pointer to the DataLogger App
+    /// @retval bool indicates success (true) or failure (!true)
+    ///
+    bool powerStats(sfeIoTNodeLoRaWAN *theApp)
+    {
+        if (!theApp)
+            return false;
+
+        uint32_t uptimeMS = millis();
+        if (uptimeMS == 0)
+            return false;
+
+        flxLog_N(F("Job Run Times"));
+        flxLog_N(F("    %-20s  %8s  %10s  %8s  %8s"), "Job", "Runs", "Total (ms)", "Avg (us)", "Max (us)");
+        for (flxJobMetrics *pMetrics = flxJobMetrics::first(); pMetrics != nullptr; pMetrics = pMetrics->next())
+            flxLog_N(F("    %-20s  %8u  %10u  %8u  %8u"), pMetrics->name(), pMetrics->nRuns(),
+                     (uint32_t)(pMetrics->totalTime() / 1000),
+                     pMetrics->nRuns() > 0 ? (uint32_t)(pMetrics->totalTime() / pMetrics->nRuns()) : 0,
+                     pMetrics->maxTime());
+        flxLog_N("");
+
+        // Time awake (main loop passes), transmitting and idle - in ms
+        uint32_t awakeMS = theApp->loopMetrics().totalTime() / 1000;
+        uint32_t txMS = theApp->_loraWANConnection.linkStats().txAirtime();
+        uint32_t idleMS = uptimeMS > awakeMS + txMS ? uptimeMS - awakeMS - txMS : 0;
+
+        float mAh = (kNLBoardCurrentAwake * awakeMS + kNLBoardCurrentIdle * idleMS + kNLBoardCurrentTx * txMS) /
+                    3600000.;
+
+        flxLog_N(F("Power Use Estimate - over %u secs"), uptimeMS / 1000);
+        flxLog_N(F("    Awake:    %10u ms  (%.2f%%), %u wakeups"), awakeMS, 100. * awakeMS / uptimeMS,
+                 theApp->loopMetrics().nRuns());
+        flxLog_N(F("    Transmit: %10u ms  (%.2f%%) - estimated time on air"), txMS, 100. * txMS / uptimeMS);
+        flxLog_N(F("    Idle:     %10u ms  (%.2f%%)"), idleMS, 100. * idleMS / uptimeMS);
+        flxLog_N(F("    Average current: %.2f mA,  estimated use: %.1f mAh/day"), mAh * 3600000. / uptimeMS,
+                 mAh * 86400000. / uptimeMS);
+        flxLog_N(F("    Battery Saver: %s - logging every %u intervals"), theApp->_batteryPolicy.tierName(),
+                 theApp->_batteryPolicy.logDivisor());
+        flxLog_N("");
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    ///
+    /// @brief output how late the periodic jobs have run - a histogram, the most late and overruns
+    ///
+    /// @param theApp Pointer to the DataLogger App
+    /// @retval bool indicates success (true) or failure (!true)
+    ///
+    bool jobLatency(sfeIoTNodeLoRaWAN *theApp)
+    {
+        if (!theApp)
+            return false;
+
+        flxLog_N(F("Job Lateness - runs by time past due"));
+        flxLog_N(F("    %-20s  %7s  %7s  %7s  %7s  %7s  %10s  %8s"), "Job", "<10ms", "<100ms", "<1s", "<10s",
+                 ">=10s", "Max (ms)", "Overruns");
+        for (flxJobMetrics *pMetrics = flxJobMetrics::first(); pMetrics != nullptr; pMetrics = pMetrics->next())
+        {
+            // only periodic jobs have lateness
+            if (pMetrics->nLateSamples() == 0)
+                continue;
+
+            flxLog_N(F("    %-20s  %7u  %7u  %7u  %7u  %7u  %10u  %8u"), pMetrics->name(), pMetrics->lateHistogram(0),
+                     pMetrics->lateHistogram(1), pMetrics->lateHistogram(2), pMetrics->lateHistogram(3),
+                     pMetrics->lateHistogram(4), pMetrics->maxLate(), pMetrics->nOverruns());
+        }
+        flxLog_N("");
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    ///
+    /// @brief list the properties that can be set remotely - with their IDs
+    ///
+    /// @param theApp Pointer to the DataLogger App
+    /// @retval bool indicates success (true) or failure (!true)
+    ///
+    bool remoteIDs(sfeIoTNodeLoRaWAN *theApp)
+    {
+        if (!theApp)
+            return false;
+
+        flxLog_N(F("Remote Configuration - LoRaWAN port %u"), kLoRaWANRemoteConfigPort);
+        flxLog_N(F("    %-6s  %-8s  %s"), "ID", "Type", "Property");
+        for (auto &entry : theApp->_remoteConfig.properties())
+            flxLog_N(F("    0x%04X  %-8s  %s.%s"), entry.id, flxGetTypeName(entry.property->type()),
+                     entry.object->name(), entry.property->name());
+        flxLog_N("");
+
         return true;
     }
 
@@ -440,6 +611,10 @@ class sfeNLCommands
         {"uptime", &sfeNLCommands::outputUpTime},
         {"verbose", &sfeNLCommands::toggleVerboseOutput},
         {"lora-status", &sfeNLCommands::loraStatus},
+        {"boot-times", &sfeNLCommands::bootTimes},
+        {"remote-ids", &sfeNLCommands::remoteIDs},
+        {"power", &sfeNLCommands::powerStats},
+        {"job-latency", &sfeNLCommands::jobLatency},
         {"device-id", &sfeNLCommands::printDeviceID},
         {"version", &sfeNLCommands::printVersion},
         {"about", &sfeNLCommands::aboutDevice},
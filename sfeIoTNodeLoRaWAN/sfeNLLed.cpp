@@ -1,4 +1,3 @@
-
 /*
  *---------------------------------------------------------------------------------
  *
@@ -8,36 +7,32 @@
  *
  *---------------------------------------------------------------------------------
  */
-// Implements onboard LED updates in an ESP32 task
+// Implements onboard LED updates - a state machine run by a one-shot FreeRTOS timer.
+//
+// Commands update the LED state stack directly (in a critical section), then kick the timer. The LED
+// is only written from the timer callback - which renders the current state, times blinks and ends
+// flashes. Flash requests go into a single slot - the last request wins - so flashes never queue up.
 
 #include "Arduino.h"
 
 #include "sfeNLBoard.h"
 #include "sfeNLLed.h"
 #include <FreeRTOS.h>
-#include <queue.h>
 #include <task.h>
 #include <timers.h>
 
-// task handle
-static TaskHandle_t hTaskLED = NULL;
-// static xTaskHandle hTaskLED = NULL;
-
-// "Command Queue"
-QueueHandle_t hCmdQueue = NULL;
-
-// size of our queue
-const uint16_t kLEDCmdQueueSize = 30;
-const uint16_t kLEDCmdQueueWait = 5;
+// Timer for the LED state machine
+static TimerHandle_t hTimer = NULL;
 
-// Time for flashing the LED
-xTimerHandle hTimer;
-const uint16_t kTimerPeriod = 100;
+// Ticks to wait when sending a command to the timer service from a task
+const TickType_t kTimerCmdWait = 10;
 
-// A task needs a Stack - let's set that size
-#define kStackSize 1600
+// Time a flash is on the LED - in ms
 #define kActivityDelay 50
 
+// Flash slot - set when a flash is pending, with the color in the lower 24 bits
+const uint32_t kFlashPending = 0x80000000;
+
 #define kLedColorOrder GRB
 #define kLedChipset WS2812
 #define kLEDBrightness 20
@@ -45,57 +40,38 @@ const uint16_t kTimerPeriod = 100;
 _sfeLED &sfeLED = _sfeLED::get();
 
 //------------------------------------------------------------------------------
-// Callback for the FreeRTOS timer -- used to blink LED
+// Callback for the FreeRTOS timer -- runs the LED state machine
 
-static void _sfeLED_TimerCallback(xTimerHandle pxTimer)
+static void _sfeLED_TimerCallback(TimerHandle_t pxTimer)
 {
     sfeLED._timerCB();
 }
 
-//--------------------------------------------------------------------------------
-// task event loop - standard C static method - for FreeRTOS
+//------------------------------------------------------------------------------
+// Start the timer - the callback runs on the next tick. Safe to call from an ISR
 
-static void _sfeLED_TaskProcessing(void *parameter)
+static void _sfeLED_Kick(void)
 {
-
-    if (hCmdQueue == NULL)
+    if (hTimer == NULL)
         return;
 
-    // startup delay
-    vTaskDelay(50);
-
-    _sfeLED::cmdStruct_t theCommand;
-
-    while (true)
+    if (portCHECK_IF_IN_ISR())
     {
-        // get next command from the queue - block if needed
-        if (xQueueReceive(hCmdQueue, &theCommand, portMAX_DELAY) != pdPASS)
-            continue; // should never get here...
-
-        // Flash commands can be compressed - skip dups in queue - if the next command is flash and this
-        // command is flash, skip it.
-
-        if (theCommand.type == _sfeLED::kCmdFlash)
-        {
-            _sfeLED::cmdStruct_t thePeek;
-
-            if (xQueuePeek(hCmdQueue, &thePeek, (TickType_t)10))
-            {
-                // skip the current flash?
-                if (thePeek.type == _sfeLED::kCmdFlash)
-                    continue;
-            }
-        }
-        // send the new command to the event processor -- in the object
-        sfeLED._eventCB(theCommand);
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        xTimerChangePeriodFromISR(hTimer, 1, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
     }
+    else
+        xTimerChangePeriod(hTimer, 1, kTimerCmdWait);
 }
 
 //---------------------------------------------------------
 // _sfeLED implementation
 //---------------------------------------------------------
 
-_sfeLED::_sfeLED() : _current{0}, _isInitialized{false}, _blinkOn{false}, _disabled{false}, _brightness{kLEDBrightness}
+_sfeLED::_sfeLED()
+    : _current{0}, _isInitialized{false}, _blinkOn{false}, _disabled{false}, _brightness{kLEDBrightness},
+      _flashColor{0}, _flashActive{false}
 {
     _colorStack[0] = {_sfeLED::Black, 0, kLEDBrightness};
 }
@@ -107,8 +83,8 @@ bool _sfeLED::initialize(void)
     // Begin setup - turn on board LED during setup.
     pinMode(kNLBoardLEDRGBBuiltin, OUTPUT);
 
-    // Create a timer, which is used to drive the user experience.
-    hTimer = xTimerCreate("ledtimer", kTimerPeriod / portTICK_RATE_MS, pdTRUE, (void *)0, _sfeLED_TimerCallback);
+    // Create the one-shot timer, which is used to drive the user experience.
+    hTimer = xTimerCreate("ledtimer", 1, pdFALSE, (void *)0, _sfeLED_TimerCallback);
     if (hTimer == NULL)
     {
         // no timer - whoa
@@ -116,36 +92,6 @@ bool _sfeLED::initialize(void)
         return false;
     }
 
-    hCmdQueue = xQueueCreate(kLEDCmdQueueSize, sizeof(cmdStruct_t));
-
-    if (hCmdQueue == NULL)
-    {
-        Serial.println("[ERROR] - LED startup - queue failed");
-        xTimerDelete(hTimer, 100);
-        hTimer = NULL;
-        return false;
-    }
-
-    // Event processing task
-    BaseType_t xReturnValue = xTaskCreate(_sfeLED_TaskProcessing, // Event processing task function
-                                          "eventProc",            // String with name of task.
-                                          kStackSize,             // Stack size in 32 bit words.
-                                          NULL,                   // Parameter passed as input of the task
-                                          1,                      // Priority of the task.
-                                          &hTaskLED);             // Task handle.
-
-    if (xReturnValue != pdPASS)
-    {
-        hTaskLED = NULL;
-        Serial.println("[ERROR] - Failure to start event processing task. Halting");
-
-        xTimerDelete(hTimer, 100);
-        hTimer = NULL;
-        vQueueDelete(hCmdQueue);
-        hCmdQueue = NULL;
-        return false;
-    }
-
     FastLED.addLeds<kLedChipset, kNLBoardLEDRGBBuiltin, kLedColorOrder>(&_theLED, 1).setCorrection(TypicalLEDStrip);
     FastLED.setBrightness(kLEDBrightness);
 
@@ -157,142 +103,119 @@ bool _sfeLED::initialize(void)
 }
 
 //------------------------------------------------------------------------------
-// Callback for the FreeRTOS timer -- used to blink LED
+// Timer callback - the LED state machine. Runs in the timer service task, so it can't block.
+//
+// Shows a pending flash, ends a flash, steps a blink or shows the current state.
 void _sfeLED::_timerCB(void)
 {
-    _theLED = _blinkOn ? _sfeLED::Black : _colorStack[_current].color;
-    FastLED.show();
-
-    _blinkOn = !_blinkOn;
-}
-
-//---------------------------------------------------------
-// Command "event" callback -
-
-void _sfeLED::_eventCB(cmdStruct_t &theCommand)
-{
-    switch (theCommand.type)
+    // A flash waiting?
+    uint32_t flash = _flashColor.exchange(0);
+    if ((flash & kFlashPending) == kFlashPending)
     {
+        _flashActive = true;
+        show(flash & 0xFFFFFF, _brightness);
+        xTimerChangePeriod(hTimer, pdMS_TO_TICKS(kActivityDelay), 0);
+        return;
+    }
+    _flashActive = false;
 
-    // LED on - new state
-    case kCmdOn:
-        pushState(theCommand.data);
-        break;
-
-    // LED off - pop current state
-    case kCmdOff:
-        popState();
-        break;
-
-    // quick flash of LED
-    case kCmdFlash:
-        pushState(theCommand.data);
-        vTaskDelay(kActivityDelay / portTICK_PERIOD_MS);
-        popState();
-        break;
-
-    // Change the blink rate
-    case kCmdBlink:
-        _colorStack[_current].ticks = theCommand.data.ticks;
-        update();
-        break;
-
-    case kCmdBrightness:
-        _brightness = theCommand.data.brightness;
-        _colorStack[_current].brightness = theCommand.data.brightness;
-        update();
-        break;
+    // the current state
+    taskENTER_CRITICAL();
+    colorState_t state = _colorStack[_current];
+    _blinkOn = state.ticks > 0 ? !_blinkOn : true;
+    bool blinkOn = _blinkOn;
+    taskEXIT_CRITICAL();
 
-    case kCmdReset:
-        _current = 0;
-        update();
-        break;
+    show(blinkOn ? state.color : _sfeLED::Black, state.brightness);
 
-    case kCmdUpdate:
-        update();
-        break;
+    // next blink step
+    if (state.ticks > 0)
+        xTimerChangePeriod(hTimer, pdMS_TO_TICKS(state.ticks), 0);
 
-    case kCmdNone:
-    default:
-        break;
-    }
+    // A flash request that arrived as the last flash ended?
+    if ((_flashColor.load() & kFlashPending) == kFlashPending)
+        xTimerChangePeriod(hTimer, 1, 0);
 }
+
 //---------------------------------------------------------
 // private.
 //---------------------------------------------------------
 
 //---------------------------------------------------------
-// Update the LED UX to reflect current state in stack
+// Write to the LED - only called from the timer callback
+
+void _sfeLED::show(sfeLEDColor_t color, uint8_t brightness)
+{
+    _theLED = color;
+    FastLED.setBrightness(brightness);
+    FastLED.show();
+}
+
+//---------------------------------------------------------
+// Update the LED UX to reflect current state in stack - a new state starts with the LED on.
+//
+// If a flash is on the LED, the end of the flash shows the new state.
 
 void _sfeLED::update(void)
 {
-    if (!_isInitialized)
+    if (!_isInitialized || _flashActive)
         return;
 
-    _theLED = _colorStack[_current].color;
-    FastLED.setBrightness(_colorStack[_current].brightness);
-    FastLED.show();
-
-    // check blink state - blink on, blink off?
-    if (_colorStack[_current].ticks > 0)
-    {
-        xTimerChangePeriod(hTimer, _colorStack[_current].ticks / portTICK_PERIOD_MS, 10);
-        xTimerReset(hTimer, 10);
-    }
-    else
-        xTimerStop(hTimer, 10);
+    _sfeLED_Kick();
 }
 
 //---------------------------------------------------------
 void _sfeLED::popState(void)
 {
-    if (_current > 0)
+    taskENTER_CRITICAL();
+    bool bChanged = _current > 0;
+    if (bChanged)
     {
         _current--;
-        update();
+        _blinkOn = false;
     }
+    taskEXIT_CRITICAL();
+
+    if (bChanged)
+        update();
 }
 //---------------------------------------------------------
 bool _sfeLED::pushState(colorState_t &newState)
 {
+    taskENTER_CRITICAL();
+    bool bRoom = _current < kStackSize - 1;
+    if (bRoom)
+    {
+        // add the new state ..
+        _current++;
+        _colorStack[_current] = newState;
+        _blinkOn = false;
+    }
+    taskEXIT_CRITICAL();
 
-    if (_current > kStackSize - 2)
+    if (!bRoom)
         return false; // no room
 
-    // add the new state ..
-    _current++;
-    _colorStack[_current] = newState;
     update();
 
     return true;
 }
 
-//---------------------------------------------------------
-// queue up a command
-
-void _sfeLED::queueCommand(cmdType_t command, sfeLEDColor_t color, uint32_t ticks)
-{
-
-    if (!_isInitialized)
-        return;
-
-    cmdStruct_t theCommand = {command, {color, ticks, _brightness}};
-
-    xQueueSend(hCmdQueue, (void *)&theCommand, 10);
-    // if (xQueueSend(hCmdQueue, (void *)&theCommand, 10) != pdPASS)
-    // Serial.println("[WARNING] - LED queue overflow"); // TODO -- DO WE CARE
-}
 //---------------------------------------------------------
 // public interface methods.
 //---------------------------------------------------------
-// Flash the  LED
+// Flash the  LED - a flash replaces any flash waiting to be shown
 
 void _sfeLED::flash(sfeLEDColor_t color)
 {
-    if (_disabled)
+    if (_disabled || !_isInitialized)
         return;
 
-    queueCommand(kCmdFlash, color);
+    _flashColor.store((color & 0xFFFFFF) | kFlashPending);
+
+    // If a flash is on the LED, the new flash follows it
+    if (!_flashActive)
+        _sfeLED_Kick();
 }
 
 //---------------------------------------------------------
@@ -303,7 +226,7 @@ void _sfeLED::off(void)
     if (_disabled)
         return;
 
-    queueCommand(kCmdOff);
+    popState();
 }
 
 //---------------------------------------------------------
@@ -314,7 +237,8 @@ void _sfeLED::on(sfeLEDColor_t color)
     if (_disabled)
         return;
 
-    queueCommand(kCmdOn, color);
+    colorState_t newState = {color, 0, _brightness};
+    pushState(newState);
 }
 
 //---------------------------------------------------------
@@ -325,7 +249,12 @@ void _sfeLED::blink(uint32_t timeout)
     if (_disabled)
         return;
 
-    queueCommand(kCmdBlink, 0, timeout);
+    taskENTER_CRITICAL();
+    _colorStack[_current].ticks = timeout;
+    _blinkOn = false;
+    taskEXIT_CRITICAL();
+
+    update();
 }
 
 //---------------------------------------------------------
@@ -336,7 +265,8 @@ void _sfeLED::blink(sfeLEDColor_t color, uint32_t timeout)
     if (_disabled)
         return;
 
-    queueCommand(kCmdOn, color, timeout);
+    colorState_t newState = {color, timeout, _brightness};
+    pushState(newState);
 }
 //---------------------------------------------------------
 void _sfeLED::stop(bool turnoff)
@@ -344,7 +274,10 @@ void _sfeLED::stop(bool turnoff)
     if (_disabled)
         return;
 
-    queueCommand(turnoff ? kCmdOff : kCmdBlink);
+    if (turnoff)
+        popState();
+    else
+        blink(0);
 }
 //---------------------------------------------------------
 // brightness
@@ -353,8 +286,12 @@ void _sfeLED::brightness(uint8_t brightness)
     if (_disabled)
         return;
 
+    taskENTER_CRITICAL();
     _brightness = brightness;
-    queueCommand(kCmdBrightness);
+    _colorStack[_current].brightness = brightness;
+    taskEXIT_CRITICAL();
+
+    update();
 }
 //---------------------------------------------------------
 // refresh
@@ -363,7 +300,7 @@ void _sfeLED::refresh(void)
     if (_disabled)
         return;
 
-    queueCommand(kCmdUpdate);
+    update();
 }
 
 //---------------------------------------------------------
@@ -376,7 +313,15 @@ void _sfeLED::setDisabled(bool bDisable)
 
     _disabled = bDisable;
 
-    // reset???
+    // reset - back to the base (off) state
     if (bDisable)
-        queueCommand(kCmdReset);
+    {
+        _flashColor = 0;
+
+        taskENTER_CRITICAL();
+        _current = 0;
+        taskEXIT_CRITICAL();
+
+        update();
+    }
 }
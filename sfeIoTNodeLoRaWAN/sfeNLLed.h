@@ -9,9 +9,11 @@
  *---------------------------------------------------------------------------------
  */
 
-// LED Display for the datalogger - led display in a task
+// LED Display for the datalogger - driven by a single one-shot FreeRTOS timer, no task
 #pragma once
 
+#include <atomic>
+
 // quiet a damn pragma message - silly
 #define FASTLED_INTERNAL
 #include <FastLED.h>
@@ -57,26 +59,6 @@ class _sfeLED
         uint8_t brightness;
     } colorState_t;
 
-    // Command Type
-    typedef enum
-    {
-        kCmdNone = 0,
-        kCmdOn = (1 << 0),
-        kCmdOff = (1 << 1),
-        kCmdFlash = (1 << 2),
-        kCmdBlink = (1 << 3),
-        kCmdReset = (1 << 4),
-        kCmdUpdate = (1 << 5),
-        kCmdBrightness = (1 << 6)
-    } cmdType_t;
-
-    // Command struct
-    typedef struct
-    {
-        cmdType_t type;
-        colorState_t data;
-    } cmdStruct_t;
-
     bool initialize(void);
     void on(sfeLEDColor_t color);
     void off(void);
@@ -88,7 +70,6 @@ class _sfeLED
     void refresh(void);
 
     void _timerCB(void);
-    void _eventCB(cmdStruct_t &);
 
     void setDisabled(bool bDisable);
 
@@ -103,7 +84,7 @@ class _sfeLED
     void popState(void);
     bool pushState(colorState_t &);
     void update(void);
-    void queueCommand(cmdType_t command, sfeLEDColor_t color = 0, uint32_t ticks = 0);
+    void show(sfeLEDColor_t color, uint8_t brightness);
 
     static constexpr uint16_t kStackSize = 20;
     colorState_t _colorStack[kStackSize];
@@ -118,5 +99,9 @@ class _sfeLED
     bool _disabled;
 
     uint8_t _brightness;
+
+    // Flash request slot - the last request wins. Set while a flash is on the LED
+    std::atomic<uint32_t> _flashColor;
+    std::atomic<bool> _flashActive;
 };
 extern _sfeLED &sfeLED;
\ No newline at end of file
@@ -0,0 +1,250 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#include "sfeNLQwiicPower.h"
+#include "sfeNLBoard.h"
+
+#include <Arduino.h>
+
+// Max device warm-up time (ms)
+const uint32_t kQwiicMaxWarmupMS = 5000;
+
+// Property values that are saved over a power off - settings, not strings or keys
+static bool isSavedType(flxDataType_t type)
+{
+    switch (type)
+    {
+    case flxTypeBool:
+    case flxTypeInt8:
+    case flxTypeInt16:
+    case flxTypeInt32:
+    case flxTypeUInt8:
+    case flxTypeUInt16:
+    case flxTypeUInt32:
+    case flxTypeFloat:
+    case flxTypeDouble:
+        return true;
+
+    default:
+        break;
+    }
+    return false;
+}
+
+// Are two values of a property the same?
+static bool isSameValue(const flxDataVariable &value1, const flxDataVariable &value2)
+{
+    if (value1.type != value2.type)
+        return false;
+
+    switch (value1.type)
+    {
+    case flxTypeBool:
+        return value1.value.b == value2.value.b;
+    case flxTypeInt8:
+        return value1.value.i8 == value2.value.i8;
+    case flxTypeInt16:
+        return value1.value.i16 == value2.value.i16;
+    case flxTypeInt32:
+        return value1.value.i32 == value2.value.i32;
+    case flxTypeUInt8:
+        return value1.value.ui8 == value2.value.ui8;
+    case flxTypeUInt16:
+        return value1.value.ui16 == value2.value.ui16;
+    case flxTypeUInt32:
+        return value1.value.ui32 == value2.value.ui32;
+    case flxTypeFloat:
+        return value1.value.f == value2.value.f;
+    case flxTypeDouble:
+        return value1.value.d == value2.value.d;
+
+    default:
+        break;
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::addDevice(flxDevice *pDevice)
+{
+    if (pDevice == nullptr)
+        return;
+
+    gatedDevice_t gated;
+    gated.device = pDevice;
+    gated.warmupTime.reset(new flxPropertyUInt32<flxDevice>(0, kQwiicMaxWarmupMS));
+    if (gated.warmupTime == nullptr)
+        return;
+
+    (*gated.warmupTime)(pDevice, "Warm-up Time",
+                        "Time (ms) needed after Qwiic power on. 0 uses the app Qwiic Warm-up Time");
+
+    _devices.push_back(std::move(gated));
+}
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::begin(uint32_t defaultWarmupMS)
+{
+    _defaultWarmupMS = defaultWarmupMS;
+
+    _warmupJob.setup("Qwiic Warm-up", warmupTime(), this, &sfeNLQwiicPower::onWarmupJob, false);
+
+    _enabled = true;
+    flxLog_I(F("Qwiic power saving enabled - %u ms warm-up"), warmupTime());
+
+    // devices are setup - power off until they're used
+    pinMode(kNLBoardEn3v3_SW, OUTPUT);
+    powerOff();
+}
+//---------------------------------------------------------------------------
+uint32_t sfeNLQwiicPower::warmupTime(void)
+{
+    uint32_t warmupMS = _defaultWarmupMS;
+
+    for (auto &gated : _devices)
+    {
+        if ((*gated.warmupTime)() > warmupMS)
+            warmupMS = (*gated.warmupTime)();
+    }
+    return warmupMS;
+}
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::run(action_t action)
+{
+    if (!action)
+        return;
+
+    if (!_enabled || _powerState == kPowerOn)
+    {
+        action();
+        return;
+    }
+
+    _pending.push_back(action);
+
+    if (_powerState == kPowerWarmup)
+        return;
+
+    powerOn();
+
+    // no warm-up needed?
+    uint32_t warmupMS = warmupTime();
+    if (warmupMS == 0)
+    {
+        onWarmupJob();
+        return;
+    }
+    _powerState = kPowerWarmup;
+    _warmupJob.setPeriod(warmupMS);
+    flxAddJobToQueue(_warmupJob);
+}
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::hold(bool bHold)
+{
+    if (!_enabled)
+        return;
+
+    if (!bHold)
+    {
+        if (_nHolds > 0 && --_nHolds == 0 && _powerState == kPowerOn)
+            powerOff();
+        return;
+    }
+
+    _nHolds++;
+    if (_powerState == kPowerOn)
+        return;
+
+    // An interactive session - wait here for the warm-up
+    if (_powerState == kPowerWarmup)
+        flxRemoveJobFromQueue(_warmupJob);
+    else
+        powerOn();
+
+    delay(warmupTime());
+    warmupComplete();
+}
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::onWarmupJob(void)
+{
+    warmupComplete();
+
+    if (_nHolds == 0)
+        powerOff();
+}
+//---------------------------------------------------------------------------
+// Devices are ready - set them up again, then run what was waiting on them
+
+void sfeNLQwiicPower::warmupComplete(void)
+{
+    _powerState = kPowerOn;
+
+    initializeDevices();
+
+    if (_onPowerOn)
+        _onPowerOn();
+
+    restoreDeviceValues();
+
+    std::vector<action_t> pending;
+    pending.swap(_pending);
+
+    for (auto &action : pending)
+        action();
+}
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::powerOn(void)
+{
+    digitalWrite(kNLBoardEn3v3_SW, HIGH);
+}
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::powerOff(void)
+{
+    saveDeviceValues();
+
+    digitalWrite(kNLBoardEn3v3_SW, LOW);
+    _powerState = kPowerOff;
+}
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::initializeDevices(void)
+{
+    for (auto &gated : _devices)
+    {
+        if (!gated.device->initialize())
+            flxLog_D(F("%s: failed to initialize after Qwiic power on"), gated.device->name());
+    }
+}
+//---------------------------------------------------------------------------
+void sfeNLQwiicPower::saveDeviceValues(void)
+{
+    _savedValues.clear();
+
+    for (auto &gated : _devices)
+    {
+        for (auto prop : gated.device->getProperties())
+        {
+            if (isSavedType(prop->type()))
+                _savedValues.push_back({prop, prop->getValue()});
+        }
+    }
+}
+//---------------------------------------------------------------------------
+// Only values changed by the power off are written - setting a value can have side effects on the device
+
+void sfeNLQwiicPower::restoreDeviceValues(void)
+{
+    for (auto &saved : _savedValues)
+    {
+        if (isSameValue(saved.first->getValue(), saved.second))
+            continue;
+
+        if (!saved.first->setValue(saved.second))
+            flxLog_D(F("Qwiic power: unable to restore %s"), saved.first->name());
+    }
+}
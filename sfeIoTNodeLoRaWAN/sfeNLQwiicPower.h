@@ -0,0 +1,105 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <Flux/flxCore.h>
+#include <Flux/flxCoreJobs.h>
+
+// Qwiic power gating - the switched 3v3 rail powers the Qwiic connectors. When gating is enabled, the rail is
+// only on while the connected devices are in use: a log cycle, a downlink that reads or sets a device, or a
+// console/menu session.
+//
+// Devices lose their state when the rail is off. Once they have warmed up, each device is initialized again -
+// the driver setup, like starting measurements - then the app setup is run, and property values that differ
+// from the values saved at power off are written back.
+//
+// Each Qwiic device gets a "Warm-up Time" property - the time (ms) it needs after power on. The rail waits for
+// the longest of these.
+
+class sfeNLQwiicPower
+{
+  public:
+    typedef std::function<void(void)> action_t;
+
+    sfeNLQwiicPower() : _enabled{false}, _powerState{kPowerOn}, _nHolds{0}, _defaultWarmupMS{0}
+    {
+    }
+
+    // Add a device on the rail - call when devices are loaded, before settings are restored
+    void addDevice(flxDevice *pDevice);
+
+    // Start gating - turns the rail off
+    void begin(uint32_t defaultWarmupMS);
+
+    // Setup the app does on the devices - run after they are initialized again at each power on
+    void setPowerOnAction(action_t action)
+    {
+        _onPowerOn = action;
+    }
+
+    bool enabled(void)
+    {
+        return _enabled;
+    }
+
+    // The time (ms) to wait after power on - the longest needed by a device
+    uint32_t warmupTime(void);
+
+    // Run an action that uses the devices - now if the rail is on, otherwise after power on and warm-up
+    void run(action_t action);
+
+    // Keep the rail on - for an interactive session, so this waits for the warm-up. Calls nest.
+    void hold(bool bHold);
+
+  private:
+    typedef enum
+    {
+        kPowerOff = 0,
+        kPowerWarmup,
+        kPowerOn
+    } powerState_t;
+
+    void powerOn(void);
+    void powerOff(void);
+    void warmupComplete(void);
+    void onWarmupJob(void);
+
+    void initializeDevices(void);
+    void saveDeviceValues(void);
+    void restoreDeviceValues(void);
+
+    bool _enabled;
+    powerState_t _powerState;
+    uint16_t _nHolds;
+    uint32_t _defaultWarmupMS;
+
+    typedef struct
+    {
+        flxDevice *device;
+        std::unique_ptr<flxPropertyUInt32<flxDevice>> warmupTime;
+    } gatedDevice_t;
+
+    std::vector<gatedDevice_t> _devices;
+
+    // Device property values saved at power off
+    std::vector<std::pair<flxProperty *, flxDataVariable>> _savedValues;
+
+    // Actions waiting on the warm-up
+    std::vector<action_t> _pending;
+
+    action_t _onPowerOn;
+
+    flxJob _warmupJob;
+};
@@ -0,0 +1,61 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Minimal test helpers for the host tests - checks are counted, and a test program returns non-zero
+// if any failed.
+
+#include <cstdio>
+#include <cstring>
+
+extern int flxTestFailures;
+
+#define FLX_CHECK(_cond_)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(_cond_))                                                                                                 \
+        {                                                                                                              \
+            printf("  FAILED: %s:%d: %s\n", __FILE__, __LINE__, #_cond_);                                              \
+            flxTestFailures++;                                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+#define FLX_CHECK_EQ(_a_, _b_)                                                                                         \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        long long _va_ = (long long)(_a_), _vb_ = (long long)(_b_);                                                    \
+        if (_va_ != _vb_)                                                                                              \
+        {                                                                                                              \
+            printf("  FAILED: %s:%d: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #_a_, #_b_, _va_, _vb_);          \
+            flxTestFailures++;                                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+// Run a test function - prints its name and result
+#define FLX_RUN_TEST(_test_)                                                                                           \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        int _before_ = flxTestFailures;                                                                                \
+        printf("%s\n", #_test_);                                                                                       \
+        _test_();                                                                                                      \
+        printf("  %s\n", flxTestFailures == _before_ ? "ok" : "FAILED");                                               \
+    } while (0)
+
+// Is the given argument on the command line?
+inline bool flxTestHasArg(int argc, char **argv, const char *arg)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], arg) == 0)
+            return true;
+    }
+    return false;
+}
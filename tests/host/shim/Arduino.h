@@ -0,0 +1,46 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - the Arduino calls used by the LoRaWAN code. Time is simulated - see flxHostShim.h
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#define F(_str_) (_str_)
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+
+// Pins - the level written is kept for the tests (see flxHostShim.h)
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+class flxHostRP2040
+{
+  public:
+    uint32_t hwrand32(void)
+    {
+        return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+    }
+    void reboot(void)
+    {
+    }
+};
+extern flxHostRP2040 rp2040;
@@ -0,0 +1,503 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - the flux core classes used by the LoRaWAN code: objects, properties, parameters and
+// devices. Just enough behavior to run the code on the host - not the SDK.
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Arduino.h"
+#include "flxCoreEvent.h"
+#include "flxCoreJobs.h"
+#include "flxCoreLog.h"
+
+//----------------------------------------------------------------------------------
+// Data types
+
+typedef enum
+{
+    flxTypeNone = 0,
+    flxTypeBool,
+    flxTypeInt8,
+    flxTypeInt16,
+    flxTypeInt32,
+    flxTypeUInt8,
+    flxTypeUInt16,
+    flxTypeUInt32,
+    flxTypeFloat,
+    flxTypeDouble,
+    flxTypeString
+} flxDataType_t;
+
+const char *flxGetTypeName(flxDataType_t type);
+
+// A value of one of the data types
+typedef struct
+{
+    flxDataType_t type;
+    union {
+        bool b;
+        int8_t i8;
+        int16_t i16;
+        int32_t i32;
+        uint8_t ui8;
+        uint16_t ui16;
+        uint32_t ui32;
+        float f;
+        double d;
+    } value;
+} flxDataVariable;
+
+// The type of a C++ type, and moving a value in and out of a variable - strings aren't held in a variable
+#define FLX_HOST_DATA_TYPE(_type_, _id_, _field_)                                                                  \
+    inline flxDataType_t flxHostTypeOf(const _type_ &)                                                             \
+    {                                                                                                              \
+        return _id_;                                                                                               \
+    }                                                                                                              \
+    inline void flxHostToVariable(const _type_ &value, flxDataVariable &var)                                      \
+    {                                                                                                              \
+        var.type = _id_;                                                                                           \
+        var.value._field_ = value;                                                                                 \
+    }                                                                                                              \
+    inline bool flxHostFromVariable(const flxDataVariable &var, _type_ &value)                                    \
+    {                                                                                                              \
+        if (var.type != _id_)                                                                                      \
+            return false;                                                                                          \
+        value = var.value._field_;                                                                                 \
+        return true;                                                                                               \
+    }
+
+FLX_HOST_DATA_TYPE(bool, flxTypeBool, b)
+FLX_HOST_DATA_TYPE(int8_t, flxTypeInt8, i8)
+FLX_HOST_DATA_TYPE(int16_t, flxTypeInt16, i16)
+FLX_HOST_DATA_TYPE(int32_t, flxTypeInt32, i32)
+FLX_HOST_DATA_TYPE(uint8_t, flxTypeUInt8, ui8)
+FLX_HOST_DATA_TYPE(uint16_t, flxTypeUInt16, ui16)
+FLX_HOST_DATA_TYPE(uint32_t, flxTypeUInt32, ui32)
+FLX_HOST_DATA_TYPE(float, flxTypeFloat, f)
+FLX_HOST_DATA_TYPE(double, flxTypeDouble, d)
+
+inline flxDataType_t flxHostTypeOf(const std::string &)
+{
+    return flxTypeString;
+}
+inline void flxHostToVariable(const std::string &, flxDataVariable &var)
+{
+    var.type = flxTypeString;
+}
+inline bool flxHostFromVariable(const flxDataVariable &, std::string &)
+{
+    return false;
+}
+
+//----------------------------------------------------------------------------------
+// Properties and objects
+
+class flxProperty
+{
+  public:
+    flxProperty() : _name{""}, _description{nullptr}
+    {
+    }
+    virtual ~flxProperty()
+    {
+    }
+    const char *name(void)
+    {
+        return _name;
+    }
+    const char *description(void)
+    {
+        return _description;
+    }
+
+    // The value - as a variable
+    virtual flxDataType_t type(void)
+    {
+        return flxTypeNone;
+    }
+    virtual flxDataVariable getValue(void)
+    {
+        flxDataVariable var;
+        var.type = flxTypeNone;
+        return var;
+    }
+    virtual bool setValue(flxDataVariable &)
+    {
+        return false;
+    }
+
+  protected:
+    void setName(const char *name, const char *description)
+    {
+        _name = name;
+        _description = description;
+    }
+
+  private:
+    const char *_name;
+    const char *_description;
+};
+
+class flxObject
+{
+  public:
+    flxObject() : _name{""}, _description{""}
+    {
+    }
+    virtual ~flxObject()
+    {
+    }
+
+    void setName(const char *name, const char *description = "")
+    {
+        _name = name;
+        _description = description;
+    }
+    const char *name(void)
+    {
+        return _name;
+    }
+    const char *description(void)
+    {
+        return _description;
+    }
+
+    void addProperty(flxProperty *pProp)
+    {
+        _properties.push_back(pProp);
+    }
+    std::vector<flxProperty *> &getProperties(void)
+    {
+        return _properties;
+    }
+
+  private:
+    const char *_name;
+    const char *_description;
+    std::vector<flxProperty *> _properties;
+};
+
+template <class T> class flxActionType : public flxObject
+{
+};
+
+// Register a property or parameter with its object
+#define flxRegister(_obj_name_, ...) _obj_name_(this, ##__VA_ARGS__)
+
+// Read/Write property - the value is held by the object, accessed via its getter and setter
+template <class Object, typename T, T (Object::*_getter)(), void (Object::*_setter)(T)>
+class _flxPropertyRW : public flxProperty
+{
+  public:
+    _flxPropertyRW() : _pObj{nullptr}
+    {
+    }
+    // range limit
+    _flxPropertyRW(T, T) : _pObj{nullptr}
+    {
+    }
+    // default value and a set of valid values
+    _flxPropertyRW(T, std::initializer_list<std::pair<const char *, T>>) : _pObj{nullptr}
+    {
+    }
+
+    void operator()(Object *pObj, const char *name, const char *description = nullptr)
+    {
+        _pObj = pObj;
+        setName(name, description);
+        pObj->addProperty(this);
+    }
+
+    T get(void)
+    {
+        return (_pObj->*_getter)();
+    }
+    void set(T value)
+    {
+        (_pObj->*_setter)(value);
+    }
+    T operator()(void)
+    {
+        return get();
+    }
+    _flxPropertyRW &operator=(T value)
+    {
+        set(value);
+        return *this;
+    }
+
+    flxDataType_t type(void) override
+    {
+        return flxHostTypeOf(T{});
+    }
+    flxDataVariable getValue(void) override
+    {
+        flxDataVariable var;
+        flxHostToVariable(get(), var);
+        return var;
+    }
+    bool setValue(flxDataVariable &var) override
+    {
+        T value;
+        if (!flxHostFromVariable(var, value))
+            return false;
+        set(value);
+        return true;
+    }
+
+  private:
+    Object *_pObj;
+};
+
+template <class Object, bool (Object::*_getter)(), void (Object::*_setter)(bool)>
+using flxPropertyRWBool = _flxPropertyRW<Object, bool, _getter, _setter>;
+template <class Object, uint8_t (Object::*_getter)(), void (Object::*_setter)(uint8_t)>
+using flxPropertyRWUInt8 = _flxPropertyRW<Object, uint8_t, _getter, _setter>;
+template <class Object, uint32_t (Object::*_getter)(), void (Object::*_setter)(uint32_t)>
+using flxPropertyRWUInt32 = _flxPropertyRW<Object, uint32_t, _getter, _setter>;
+template <class Object, std::string (Object::*_getter)(), void (Object::*_setter)(std::string)>
+using flxPropertyRWString = _flxPropertyRW<Object, std::string, _getter, _setter>;
+template <class Object, std::string (Object::*_getter)(), void (Object::*_setter)(std::string)>
+using flxPropertyRWSecureString = _flxPropertyRW<Object, std::string, _getter, _setter>;
+
+// Property - the value is held by the property
+template <class Object, typename T> class _flxPropertyValue : public flxProperty
+{
+  public:
+    _flxPropertyValue() : _value{}
+    {
+    }
+    _flxPropertyValue(T value) : _value{value}
+    {
+    }
+    // range limit
+    _flxPropertyValue(T, T) : _value{}
+    {
+    }
+    _flxPropertyValue(T value, T, T) : _value{value}
+    {
+    }
+
+    void operator()(Object *pObj, const char *name, const char *description = nullptr)
+    {
+        setName(name, description);
+        pObj->addProperty(this);
+    }
+
+    T get(void)
+    {
+        return _value;
+    }
+    void set(T value)
+    {
+        _value = value;
+    }
+    T operator()(void)
+    {
+        return _value;
+    }
+    _flxPropertyValue &operator=(T value)
+    {
+        _value = value;
+        return *this;
+    }
+
+    flxDataType_t type(void) override
+    {
+        return flxHostTypeOf(_value);
+    }
+    flxDataVariable getValue(void) override
+    {
+        flxDataVariable var;
+        flxHostToVariable(_value, var);
+        return var;
+    }
+    bool setValue(flxDataVariable &var) override
+    {
+        return flxHostFromVariable(var, _value);
+    }
+
+  private:
+    T _value;
+};
+
+template <class Object> using flxPropertyHiddenUInt32 = _flxPropertyValue<Object, uint32_t>;
+template <class Object> using flxPropertyUInt8 = _flxPropertyValue<Object, uint8_t>;
+template <class Object> using flxPropertyUInt32 = _flxPropertyValue<Object, uint32_t>;
+
+// Input parameter - a function of the object
+template <class Object, void (Object::*_method)()> class flxParameterInVoid
+{
+  public:
+    void operator()(Object *pObj, const char *, const char * = nullptr)
+    {
+        _pObj = pObj;
+    }
+    void operator()(void)
+    {
+        (_pObj->*_method)();
+    }
+
+  private:
+    Object *_pObj = nullptr;
+};
+
+//----------------------------------------------------------------------------------
+// Output parameters - the interfaces the logger reads device values through
+
+const uint32_t kParameterOutFlagArray = 0x01;
+
+class flxParameterOut
+{
+  public:
+    virtual ~flxParameterOut()
+    {
+    }
+    virtual const char *name(void) = 0;
+    virtual bool enabled(void) = 0;
+    virtual uint8_t valueType(void) = 0;
+    virtual uint32_t flags(void) = 0;
+    virtual flxDataType_t type(void) = 0;
+
+    // The scalar or array accessor for the value
+    virtual void *accessor(void) = 0;
+};
+
+class flxParameterOutScalar
+{
+  public:
+    virtual ~flxParameterOutScalar()
+    {
+    }
+    virtual const char *name(void) = 0;
+    virtual uint8_t valueType(void) = 0;
+
+    virtual bool getBool(void) = 0;
+    virtual int8_t getInt8(void) = 0;
+    virtual int16_t getInt16(void) = 0;
+    virtual int32_t getInt32(void) = 0;
+    virtual uint8_t getUInt8(void) = 0;
+    virtual uint16_t getUInt16(void) = 0;
+    virtual uint32_t getUInt32(void) = 0;
+    virtual float getFloat(void) = 0;
+};
+
+class flxDataArray
+{
+  public:
+    virtual ~flxDataArray()
+    {
+    }
+};
+
+class flxDataArrayFloat : public flxDataArray
+{
+  public:
+    void set(const float *pData, size_t len)
+    {
+        _data.assign(pData, pData + len);
+    }
+    size_t size(void)
+    {
+        return _data.size();
+    }
+    float *get(void)
+    {
+        return _data.data();
+    }
+
+  private:
+    std::vector<float> _data;
+};
+
+class flxParameterOutArray
+{
+  public:
+    virtual ~flxParameterOutArray()
+    {
+    }
+    virtual uint8_t valueType(void) = 0;
+    virtual flxDataArray *get(void) = 0;
+};
+
+//----------------------------------------------------------------------------------
+// Devices
+
+class flxDevice : public flxObject
+{
+  public:
+    virtual bool initialize(void)
+    {
+        return true;
+    }
+    virtual bool execute(void)
+    {
+        return true;
+    }
+
+    void addOutputParameter(flxParameterOut *pParam)
+    {
+        _outputParameters.push_back(pParam);
+    }
+    std::vector<flxParameterOut *> &getOutputParameters(void)
+    {
+        return _outputParameters;
+    }
+
+  private:
+    std::vector<flxParameterOut *> _outputParameters;
+};
+
+class flxDeviceContainer : public std::vector<flxDevice *>
+{
+  public:
+    void setName(const char *)
+    {
+    }
+    void remove(flxDevice *pDevice)
+    {
+        for (auto it = begin(); it != end(); it++)
+        {
+            if (*it == pDevice)
+            {
+                erase(it);
+                break;
+            }
+        }
+    }
+};
+
+//----------------------------------------------------------------------------------
+// Signals
+
+class flxSignalVoid
+{
+  public:
+    template <typename T> void call(T *obj, void (T::*method)())
+    {
+        _slots.push_back([obj, method]() { (obj->*method)(); });
+    }
+    void emit(void)
+    {
+        for (auto &slot : _slots)
+            slot();
+    }
+
+  private:
+    std::vector<std::function<void()>> _slots;
+};
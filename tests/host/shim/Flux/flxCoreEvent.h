@@ -0,0 +1,54 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - flux events. Events are delivered when sent; values are passed as a uint32_t, which
+// covers the event value types used by the LoRaWAN code (bool and integer codes).
+
+#include <cstdint>
+#include <functional>
+
+typedef const void *flxEventID_t;
+
+// an event ID is the address of a tag - unique across translation units
+#define flxDefineEventID(_name_)                                                                                       \
+    namespace flxEvent                                                                                                 \
+    {                                                                                                                  \
+    inline const char _name_##_tag = 0;                                                                                \
+    inline const flxEventID_t _name_ = &_name_##_tag;                                                                  \
+    }
+
+flxDefineEventID(kOnConnectionChange);
+flxDefineEventID(kSystemNeedsRestart);
+flxDefineEventID(kOnSystemReset);
+
+void flxHostRegisterEvent(flxEventID_t id, std::function<void(uint32_t)> handler);
+void flxHostSendEvent(flxEventID_t id, uint32_t value);
+
+template <typename T> void flxSendEvent(flxEventID_t id, T value)
+{
+    flxHostSendEvent(id, (uint32_t)value);
+}
+
+inline void flxSendEvent(flxEventID_t id)
+{
+    flxHostSendEvent(id, 0);
+}
+
+template <typename O, typename T> void flxRegisterEventCB(flxEventID_t id, O *obj, void (O::*method)(T))
+{
+    flxHostRegisterEvent(id, [obj, method](uint32_t value) { (obj->*method)((T)value); });
+}
+
+template <typename O> void flxRegisterEventCB(flxEventID_t id, O *obj, void (O::*method)(void))
+{
+    flxHostRegisterEvent(id, [obj, method](uint32_t) { (obj->*method)(); });
+}
@@ -0,0 +1,66 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - flux jobs. The queue is run by flxHostRunJobs() on the simulated clock (see flxHostShim.h)
+
+#include <cstdint>
+#include <functional>
+
+class flxJob
+{
+  public:
+    flxJob() : _name{""}, _period{0}, _repeat{true}
+    {
+    }
+
+    template <typename T> void setup(const char *name, uint32_t period, T *obj, void (T::*method)(), bool repeat = true)
+    {
+        _name = name;
+        _period = period;
+        _repeat = repeat;
+        _callback = [obj, method]() { (obj->*method)(); };
+    }
+
+    const char *name(void)
+    {
+        return _name;
+    }
+    uint32_t period(void)
+    {
+        return _period;
+    }
+    void setPeriod(uint32_t period)
+    {
+        _period = period;
+    }
+    bool repeat(void)
+    {
+        return _repeat;
+    }
+    void callback(void)
+    {
+        if (_callback)
+            _callback();
+    }
+
+  private:
+    const char *_name;
+    uint32_t _period;
+    bool _repeat;
+    std::function<void()> _callback;
+};
+
+// Queue a job - it runs one period from now. A job already queued is rescheduled
+void flxAddJobToQueue(flxJob &theJob);
+void flxRemoveJobFromQueue(flxJob &theJob);
+// Reschedule a queued job - for a change in period
+void flxUpdateJobInQueue(flxJob &theJob);
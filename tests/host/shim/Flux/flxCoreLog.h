@@ -0,0 +1,33 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - flux logging. Messages are counted by level, and printed when output is enabled
+// (see flxHostShim.h). The "_" variants don't end the line.
+
+#include "Arduino.h"
+
+void flxHostLog(char level, bool bNewline, const char *format, ...);
+bool flxIsLoggingVerbose(void);
+
+#define flxLog_E(_format_, ...) flxHostLog('E', true, _format_, ##__VA_ARGS__)
+#define flxLog_W(_format_, ...) flxHostLog('W', true, _format_, ##__VA_ARGS__)
+#define flxLog_I(_format_, ...) flxHostLog('I', true, _format_, ##__VA_ARGS__)
+#define flxLog_D(_format_, ...) flxHostLog('D', true, _format_, ##__VA_ARGS__)
+#define flxLog_V(_format_, ...) flxHostLog('V', true, _format_, ##__VA_ARGS__)
+#define flxLog_N(_format_, ...) flxHostLog('N', true, _format_, ##__VA_ARGS__)
+
+#define flxLog_E_(_format_, ...) flxHostLog('E', false, _format_, ##__VA_ARGS__)
+#define flxLog_W_(_format_, ...) flxHostLog('W', false, _format_, ##__VA_ARGS__)
+#define flxLog_I_(_format_, ...) flxHostLog('I', false, _format_, ##__VA_ARGS__)
+#define flxLog_D_(_format_, ...) flxHostLog('D', false, _format_, ##__VA_ARGS__)
+#define flxLog_V_(_format_, ...) flxHostLog('V', false, _format_, ##__VA_ARGS__)
+#define flxLog_N_(_format_, ...) flxHostLog('N', false, _format_, ##__VA_ARGS__)
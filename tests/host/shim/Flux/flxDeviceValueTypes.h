@@ -0,0 +1,25 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - device value type IDs. IDs for the host tests - the code under test only relies on
+// kParamValueNone being 0
+
+#include <cstdint>
+
+const uint8_t kParamValueNone = 0x00;
+const uint8_t kParamValueTemperature = 0x01;
+const uint8_t kParamValueHumidity = 0x02;
+const uint8_t kParamValuePressure = 0x03;
+const uint8_t kParamValueBattery = 0x04;
+const uint8_t kParamValueCount = 0x05;
+const uint8_t kParamValueState = 0x06;
+const uint8_t kParamValueLocation = 0x07;
@@ -0,0 +1,19 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - the flux framework object
+
+#include "flxCore.h"
+
+template <typename T> void flux_add(T *)
+{
+}
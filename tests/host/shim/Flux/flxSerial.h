@@ -0,0 +1,34 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - serial console text colors. No-ops on the host
+
+class flxHostSerial
+{
+  public:
+    void textToWhite(void)
+    {
+    }
+    void textToGreen(void)
+    {
+    }
+    void textToRed(void)
+    {
+    }
+    void textToYellow(void)
+    {
+    }
+    void textToNormal(void)
+    {
+    }
+};
+extern flxHostSerial flxSerial;
@@ -0,0 +1,36 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - the settings store. Saves are counted, nothing is stored
+
+#include <cstdint>
+
+class flxHostSettings
+{
+  public:
+    flxHostSettings() : _nSaves{0}
+    {
+    }
+    template <typename T> bool save(T *, bool = false)
+    {
+        _nSaves++;
+        return true;
+    }
+    uint32_t nSaves(void)
+    {
+        return _nSaves;
+    }
+
+  private:
+    uint32_t _nSaves;
+};
+extern flxHostSettings flxSettings;
@@ -0,0 +1,276 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+// Host test shim - the simulated clock, job queue, events and logging
+
+#include "flxHostShim.h"
+
+#include <Arduino.h>
+#include <Flux/flxCore.h>
+#include <Flux/flxSerial.h>
+#include <Flux/flxSettings.h>
+#include <task.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <map>
+
+flxHostRP2040 rp2040;
+flxHostSerial flxSerial;
+flxHostSettings flxSettings;
+
+//----------------------------------------------------------------------------------
+// Clock
+
+static uint32_t _timeMS = 0;
+
+void flxHostSetTime(uint32_t timeMS)
+{
+    _timeMS = timeMS;
+}
+
+void flxHostAdvanceTime(uint32_t ms)
+{
+    _timeMS += ms;
+}
+
+uint32_t millis(void)
+{
+    return _timeMS;
+}
+
+// Run times are measured - so micros() is the real clock
+uint32_t micros(void)
+{
+    static auto startTime = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                           startTime)
+        .count();
+}
+
+void delay(uint32_t ms)
+{
+    flxHostAdvanceTime(ms);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    flxHostAdvanceTime(ticks * portTICK_PERIOD_MS);
+}
+
+//----------------------------------------------------------------------------------
+// Pins
+
+static uint8_t _pinLevels[256] = {0};
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    _pinLevels[pin] = value;
+}
+
+int digitalRead(uint8_t pin)
+{
+    return _pinLevels[pin];
+}
+
+int flxHostPinLevel(uint8_t pin)
+{
+    return _pinLevels[pin];
+}
+
+//----------------------------------------------------------------------------------
+// Job queue
+
+typedef struct
+{
+    flxJob *job;
+    uint32_t dueMS;
+    uint32_t seq; // queue order - changes when the job is queued again
+} hostJob_t;
+
+static std::vector<hostJob_t> _jobs;
+static uint32_t _jobSeq = 0;
+
+static hostJob_t *findJob(flxJob &theJob)
+{
+    for (auto &entry : _jobs)
+    {
+        if (entry.job == &theJob)
+            return &entry;
+    }
+    return nullptr;
+}
+
+void flxAddJobToQueue(flxJob &theJob)
+{
+    hostJob_t *pEntry = findJob(theJob);
+    if (pEntry == nullptr)
+    {
+        _jobs.push_back({&theJob, 0, 0});
+        pEntry = &_jobs.back();
+    }
+    pEntry->dueMS = _timeMS + theJob.period();
+    pEntry->seq = ++_jobSeq;
+}
+
+void flxRemoveJobFromQueue(flxJob &theJob)
+{
+    for (auto it = _jobs.begin(); it != _jobs.end(); it++)
+    {
+        if (it->job == &theJob)
+        {
+            _jobs.erase(it);
+            return;
+        }
+    }
+}
+
+void flxUpdateJobInQueue(flxJob &theJob)
+{
+    if (findJob(theJob) != nullptr)
+        flxAddJobToQueue(theJob);
+}
+
+size_t flxHostJobsQueued(void)
+{
+    return _jobs.size();
+}
+
+void flxHostRunJobs(uint32_t ms)
+{
+    uint32_t endMS = _timeMS + ms;
+
+    while (true)
+    {
+        // next job due - earliest time, then queue order
+        hostJob_t *pNext = nullptr;
+        for (auto &entry : _jobs)
+        {
+            if ((int32_t)(entry.dueMS - endMS) > 0)
+                continue;
+            if (pNext == nullptr || (int32_t)(entry.dueMS - pNext->dueMS) < 0 ||
+                (entry.dueMS == pNext->dueMS && entry.seq < pNext->seq))
+                pNext = &entry;
+        }
+        if (pNext == nullptr)
+            break;
+
+        if ((int32_t)(pNext->dueMS - _timeMS) > 0)
+            _timeMS = pNext->dueMS;
+
+        flxJob *pJob = pNext->job;
+        uint32_t seq = pNext->seq;
+
+        if (!pJob->repeat())
+            flxRemoveJobFromQueue(*pJob);
+
+        pJob->callback();
+
+        // reschedule - unless the callback queued or removed the job
+        if (pJob->repeat())
+        {
+            hostJob_t *pEntry = findJob(*pJob);
+            if (pEntry != nullptr && pEntry->seq == seq)
+                pEntry->dueMS = _timeMS + (pJob->period() > 0 ? pJob->period() : 1);
+        }
+    }
+    if ((int32_t)(endMS - _timeMS) > 0)
+        _timeMS = endMS;
+}
+
+//----------------------------------------------------------------------------------
+// Events
+
+static std::map<flxEventID_t, std::vector<std::function<void(uint32_t)>>> _eventHandlers;
+
+void flxHostRegisterEvent(flxEventID_t id, std::function<void(uint32_t)> handler)
+{
+    _eventHandlers[id].push_back(handler);
+}
+
+void flxHostSendEvent(flxEventID_t id, uint32_t value)
+{
+    auto it = _eventHandlers.find(id);
+    if (it == _eventHandlers.end())
+        return;
+
+    // a copy - handlers can register handlers
+    std::vector<std::function<void(uint32_t)>> handlers = it->second;
+    for (auto &handler : handlers)
+        handler(value);
+}
+
+void flxHostReset(void)
+{
+    _jobs.clear();
+    _eventHandlers.clear();
+}
+
+//----------------------------------------------------------------------------------
+// Logging
+
+static bool _logOutput = false;
+static bool _logVerbose = false;
+static std::map<char, uint32_t> _logCounts;
+
+void flxHostSetLogOutput(bool bOutput)
+{
+    _logOutput = bOutput;
+}
+
+void flxHostSetVerbose(bool bVerbose)
+{
+    _logVerbose = bVerbose;
+}
+
+bool flxIsLoggingVerbose(void)
+{
+    return _logVerbose;
+}
+
+uint32_t flxHostLogCount(char level)
+{
+    return _logCounts[level];
+}
+
+void flxHostClearLogCounts(void)
+{
+    _logCounts.clear();
+}
+
+void flxHostLog(char level, bool bNewline, const char *format, ...)
+{
+    _logCounts[level]++;
+
+    if (!_logOutput || (level == 'V' && !_logVerbose))
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+
+    if (bNewline)
+        printf("\n");
+}
+
+//----------------------------------------------------------------------------------
+const char *flxGetTypeName(flxDataType_t type)
+{
+    static const char *typeNames[] = {"none",   "bool",   "int8",  "int16",  "int32", "uint8",
+                                      "uint16", "uint32", "float", "double", "string"};
+
+    return type <= flxTypeString ? typeNames[type] : "unknown";
+}
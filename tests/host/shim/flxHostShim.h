@@ -0,0 +1,37 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+#pragma once
+
+// Host test shim - controls for the tests. Time is simulated: millis() only moves when the job queue is
+// run, or delay() is called.
+
+#include <cstddef>
+#include <cstdint>
+
+// The simulated clock - ms
+void flxHostSetTime(uint32_t timeMS);
+void flxHostAdvanceTime(uint32_t ms);
+
+// The level last written to a pin
+int flxHostPinLevel(uint8_t pin);
+
+// Run the queued jobs that are due over the next ms milliseconds - in time order, advancing the clock
+void flxHostRunJobs(uint32_t ms);
+size_t flxHostJobsQueued(void);
+
+// Clear the job queue and event handlers - between tests
+void flxHostReset(void);
+
+// Logging - print the messages (off by default), verbose output, and the count of messages of a level
+void flxHostSetLogOutput(bool bOutput);
+void flxHostSetVerbose(bool bVerbose);
+uint32_t flxHostLogCount(char level);
+void flxHostClearLogCounts(void);
@@ -0,0 +1,343 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+// Host tests for firmware update reassembly - flxLoRaWANFragDecoder with random and burst fragment loss,
+// and the SHA-256 digest used to verify the image.
+
+#include "flxHostTest.h"
+
+#include "flxLoRaWANFragDecoder.h"
+#include "flxSHA256.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+int flxTestFailures = 0;
+
+//----------------------------------------------------------------------------------
+// Fragment store in memory
+
+class memoryStore : public flxLoRaWANFragStore
+{
+  public:
+    bool writeAt(uint32_t offset, const uint8_t *data, size_t len)
+    {
+        if (_data.size() < offset + len)
+            _data.resize(offset + len, 0);
+        memcpy(_data.data() + offset, data, len);
+        return true;
+    }
+    bool readAt(uint32_t offset, uint8_t *data, size_t len)
+    {
+        if (offset + len > _data.size())
+            return false;
+        memcpy(data, _data.data() + offset, len);
+        return true;
+    }
+    std::vector<uint8_t> _data;
+};
+
+//----------------------------------------------------------------------------------
+// A block sent as fragments - data then parity, as the sender builds them
+
+class testBlock
+{
+  public:
+    testBlock(uint16_t nFragments, uint8_t fragSize, uint8_t nParity, uint32_t seed)
+        : nFragments{nFragments}, fragSize{fragSize}, nParity{nParity}
+    {
+        std::minstd_rand random(seed);
+
+        image.resize((size_t)nFragments * fragSize);
+        for (auto &byte : image)
+            byte = random() & 0xFF;
+
+        fragments.resize((size_t)nFragments + nParity, std::vector<uint8_t>(fragSize, 0));
+        for (uint16_t i = 0; i < nFragments; i++)
+        {
+            fragments[i].assign(image.begin() + (size_t)i * fragSize, image.begin() + (size_t)(i + 1) * fragSize);
+            if (nParity == 0)
+                continue;
+            std::vector<uint8_t> &parity = fragments[nFragments + i % nParity];
+            for (int j = 0; j < fragSize; j++)
+                parity[j] ^= fragments[i][j];
+        }
+    }
+
+    // Send the fragments, except those lost. Returns true if the decoder completed the block.
+    bool send(flxLoRaWANFragDecoder &decoder, memoryStore &store, const std::vector<bool> &lost)
+    {
+        if (!decoder.begin(&store, nFragments, fragSize, nParity))
+            return false;
+
+        for (size_t i = 0; i < fragments.size(); i++)
+        {
+            if (!lost[i])
+                decoder.addFragment(i, fragments[i].data(), fragSize);
+        }
+        return decoder.isComplete();
+    }
+
+    // Can the block be recovered with these fragments lost? At most one data fragment lost per parity
+    // group - and that group's parity received
+    bool recoverable(const std::vector<bool> &lost)
+    {
+        for (uint16_t group = 0; group < nParity; group++)
+        {
+            int nLost = 0;
+            for (uint32_t i = group; i < nFragments; i += nParity)
+                nLost += lost[i] ? 1 : 0;
+            if (nLost > 1 || (nLost == 1 && lost[nFragments + group]))
+                return false;
+        }
+        return true;
+    }
+
+    bool imageMatches(memoryStore &store)
+    {
+        return store._data.size() >= image.size() && std::equal(image.begin(), image.end(), store._data.begin());
+    }
+
+    uint16_t nFragments;
+    uint8_t fragSize;
+    uint8_t nParity;
+    std::vector<uint8_t> image;
+    std::vector<std::vector<uint8_t>> fragments;
+};
+
+//----------------------------------------------------------------------------------
+// Tests
+
+static void testNoLoss(void)
+{
+    testBlock block(200, 50, 10, 1);
+    flxLoRaWANFragDecoder decoder;
+    memoryStore store;
+
+    FLX_CHECK(block.send(decoder, store, std::vector<bool>(block.fragments.size(), false)));
+    FLX_CHECK_EQ(decoder.nRecovered(), 0);
+    FLX_CHECK(block.imageMatches(store));
+}
+
+// Random loss - the block completes exactly when every parity group can be recovered, and the recovered
+// image is the one sent
+static void testRandomLoss(void)
+{
+    int nRecoverable = 0;
+    int nUnrecoverable = 0;
+
+    for (uint32_t seed = 1; seed <= 200; seed++)
+    {
+        testBlock block(500, 64, 25, seed);
+        std::minstd_rand random(seed);
+        uint32_t lossPercent = 1 + seed % 8;
+
+        std::vector<bool> lost(block.fragments.size());
+        for (size_t i = 0; i < lost.size(); i++)
+            lost[i] = random() % 100 < lossPercent;
+
+        flxLoRaWANFragDecoder decoder;
+        memoryStore store;
+        bool bComplete = block.send(decoder, store, lost);
+        bool bRecoverable = block.recoverable(lost);
+
+        FLX_CHECK_EQ(bComplete, bRecoverable);
+        if (bComplete)
+        {
+            FLX_CHECK(block.imageMatches(store));
+            nRecoverable++;
+        }
+        else
+        {
+            FLX_CHECK(decoder.nMissing() > 0);
+            nUnrecoverable++;
+        }
+    }
+    // the loss rates cover both outcomes
+    FLX_CHECK(nRecoverable > 0);
+    FLX_CHECK(nUnrecoverable > 0);
+}
+
+// Burst loss - the groups are interleaved, so a burst of up to nParity data fragments is recovered
+static void testBurstLoss(void)
+{
+    const uint8_t nParity = 16;
+    testBlock block(300, 48, nParity, 7);
+
+    for (uint16_t start : {0, 1, 100, 300 - nParity})
+    {
+        std::vector<bool> lost(block.fragments.size(), false);
+        for (uint16_t i = start; i < start + nParity; i++)
+            lost[i] = true;
+
+        flxLoRaWANFragDecoder decoder;
+        memoryStore store;
+        FLX_CHECK(block.send(decoder, store, lost));
+        FLX_CHECK_EQ(decoder.nRecovered(), nParity);
+        FLX_CHECK(block.imageMatches(store));
+    }
+
+    // one more than that - two lost in a group
+    std::vector<bool> lost(block.fragments.size(), false);
+    for (uint16_t i = 50; i < 50 + nParity + 1; i++)
+        lost[i] = true;
+
+    flxLoRaWANFragDecoder decoder;
+    memoryStore store;
+    FLX_CHECK(!block.send(decoder, store, lost));
+    FLX_CHECK_EQ(decoder.nMissing(), 2);
+}
+
+// Parity fragments first - recovery happens as the last data fragment of a group arrives
+static void testParityFirst(void)
+{
+    testBlock block(40, 20, 4, 3);
+    flxLoRaWANFragDecoder decoder;
+    memoryStore store;
+
+    FLX_CHECK(decoder.begin(&store, block.nFragments, block.fragSize, block.nParity));
+    for (uint16_t i = block.nFragments; i < block.fragments.size(); i++)
+        decoder.addFragment(i, block.fragments[i].data(), block.fragSize);
+
+    // all but the first fragment of each group
+    for (uint16_t i = block.nParity; i < block.nFragments; i++)
+        decoder.addFragment(i, block.fragments[i].data(), block.fragSize);
+
+    FLX_CHECK(decoder.isComplete());
+    FLX_CHECK_EQ(decoder.nRecovered(), block.nParity);
+    FLX_CHECK(block.imageMatches(store));
+}
+
+static void testInvalidFragments(void)
+{
+    testBlock block(10, 16, 2, 5);
+    flxLoRaWANFragDecoder decoder;
+    memoryStore store;
+
+    FLX_CHECK(decoder.begin(&store, block.nFragments, block.fragSize, block.nParity));
+    FLX_CHECK_EQ(decoder.addFragment(0, block.fragments[0].data(), block.fragSize), flxLoRaWANFragDecoder::kFragAdded);
+    FLX_CHECK_EQ(decoder.addFragment(0, block.fragments[0].data(), block.fragSize),
+                 flxLoRaWANFragDecoder::kFragDuplicate);
+    FLX_CHECK_EQ(decoder.addFragment(1, block.fragments[1].data(), block.fragSize - 1),
+                 flxLoRaWANFragDecoder::kFragInvalid);
+    FLX_CHECK_EQ(decoder.addFragment(12, block.fragments[1].data(), block.fragSize),
+                 flxLoRaWANFragDecoder::kFragInvalid);
+    FLX_CHECK_EQ(decoder.nMissing(), 9);
+}
+
+// Session parameters - every fragment index has to fit in 16 bits
+static void testSessionLimits(void)
+{
+    flxLoRaWANFragDecoder decoder;
+    memoryStore store;
+
+    FLX_CHECK(!decoder.begin(&store, 0, 16, 0));
+    FLX_CHECK(!decoder.begin(&store, 10, 0, 0));
+    FLX_CHECK(!decoder.begin(&store, 10, flxLoRaWANFragDecoder::kMaxFragSize + 1, 0));
+    FLX_CHECK(!decoder.begin(&store, flxLoRaWANFragDecoder::kMaxFragments + 1, 16, 0));
+    FLX_CHECK(!decoder.begin(nullptr, 10, 16, 0));
+
+    FLX_CHECK(decoder.begin(&store, flxLoRaWANFragDecoder::kMaxFragments, 16, 0xFFFF - 0xFFF0));
+    FLX_CHECK(!decoder.begin(&store, flxLoRaWANFragDecoder::kMaxFragments, 16, 0xFFFF - 0xFFF0 + 1));
+    FLX_CHECK(!decoder.begin(&store, flxLoRaWANFragDecoder::kMaxFragments, 16, flxLoRaWANFragDecoder::kMaxParity));
+    FLX_CHECK(!decoder.active());
+}
+
+//----------------------------------------------------------------------------------
+// SHA-256 - FIPS 180-4 test vectors
+
+static std::string sha256Hex(const std::vector<std::string> &pieces, size_t repeat = 1)
+{
+    flxSHA256 sha;
+    for (size_t i = 0; i < repeat; i++)
+    {
+        for (auto &piece : pieces)
+            sha.update((const uint8_t *)piece.data(), piece.size());
+    }
+    uint8_t digest[flxSHA256::kDigestSize];
+    sha.finish(digest);
+
+    std::string hex;
+    char buffer[3];
+    for (uint8_t byte : digest)
+    {
+        snprintf(buffer, sizeof(buffer), "%02x", byte);
+        hex += buffer;
+    }
+    return hex;
+}
+
+static void testSHA256(void)
+{
+    FLX_CHECK(sha256Hex({""}) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    FLX_CHECK(sha256Hex({"abc"}) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    FLX_CHECK(sha256Hex({"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"}) ==
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // in pieces that don't line up with the blocks
+    FLX_CHECK(sha256Hex({"abcdbcdecdefdefgefgh", "fghighijhijkijkljklmklm", "nlmnomnopnopq"}) ==
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    // a million 'a'
+    FLX_CHECK(sha256Hex({std::string(1000, 'a')}, 1000) ==
+              "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+// The image digest over the recovered store - as the firmware update checks it
+static void testImageDigest(void)
+{
+    testBlock block(100, 100, 8, 11);
+    std::vector<bool> lost(block.fragments.size(), false);
+    for (uint16_t i = 20; i < 28; i++)
+        lost[i] = true;
+
+    flxLoRaWANFragDecoder decoder;
+    memoryStore store;
+    FLX_CHECK(block.send(decoder, store, lost));
+
+    uint32_t imageSize = block.image.size() - 37;
+
+    uint8_t expected[flxSHA256::kDigestSize];
+    flxSHA256 sha;
+    sha.update(block.image.data(), imageSize);
+    sha.finish(expected);
+
+    // read back a piece at a time
+    uint8_t buffer[256];
+    for (uint32_t offset = 0; offset < imageSize;)
+    {
+        size_t nRead = imageSize - offset < sizeof(buffer) ? imageSize - offset : sizeof(buffer);
+        FLX_CHECK(store.readAt(offset, buffer, nRead));
+        sha.update(buffer, nRead);
+        offset += nRead;
+    }
+    uint8_t digest[flxSHA256::kDigestSize];
+    sha.finish(digest);
+
+    FLX_CHECK(memcmp(digest, expected, sizeof(digest)) == 0);
+}
+
+//----------------------------------------------------------------------------------
+int main(int, char **)
+{
+    FLX_RUN_TEST(testNoLoss);
+    FLX_RUN_TEST(testRandomLoss);
+    FLX_RUN_TEST(testBurstLoss);
+    FLX_RUN_TEST(testParityFirst);
+    FLX_RUN_TEST(testInvalidFragments);
+    FLX_RUN_TEST(testSessionLimits);
+    FLX_RUN_TEST(testSHA256);
+    FLX_RUN_TEST(testImageDigest);
+
+    printf("%s\n", flxTestFailures == 0 ? "All tests passed" : "Tests FAILED");
+    return flxTestFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,596 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+// Host tests for the LoRaWAN uplink pipeline - flxLoRaWANLogger packing device values, and
+// flxLoRaWANDigi sending them, through the simulated modem.
+//
+// Run with --bench for a timing run of the logging path.
+
+#include "flxHostShim.h"
+#include "flxHostTest.h"
+
+#include "flxLoRaWANDigi.h"
+#include "flxLoRaWANLogger.h"
+#include "flxLoRaWANTransportSim.h"
+#include <Flux/flxDeviceValueTypes.h>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+int flxTestFailures = 0;
+
+//----------------------------------------------------------------------------------
+// Test device - output parameters with fixed values
+
+class testScalar : public flxParameterOut, public flxParameterOutScalar
+{
+  public:
+    testScalar(const char *name, flxDataType_t type, uint8_t valueType, double value)
+        : _name{name}, _type{type}, _valueType{valueType}, _value{value}, _enabled{true}
+    {
+    }
+    const char *name(void)
+    {
+        return _name;
+    }
+    bool enabled(void)
+    {
+        return _enabled;
+    }
+    void setEnabled(bool bEnabled)
+    {
+        _enabled = bEnabled;
+    }
+    uint8_t valueType(void)
+    {
+        return _valueType;
+    }
+    uint32_t flags(void)
+    {
+        return 0;
+    }
+    flxDataType_t type(void)
+    {
+        return _type;
+    }
+    void *accessor(void)
+    {
+        return static_cast<flxParameterOutScalar *>(this);
+    }
+
+    bool getBool(void)
+    {
+        return _value != 0;
+    }
+    int8_t getInt8(void)
+    {
+        return (int8_t)_value;
+    }
+    int16_t getInt16(void)
+    {
+        return (int16_t)_value;
+    }
+    int32_t getInt32(void)
+    {
+        return (int32_t)_value;
+    }
+    uint8_t getUInt8(void)
+    {
+        return (uint8_t)_value;
+    }
+    uint16_t getUInt16(void)
+    {
+        return (uint16_t)_value;
+    }
+    uint32_t getUInt32(void)
+    {
+        return (uint32_t)_value;
+    }
+    float getFloat(void)
+    {
+        return (float)_value;
+    }
+
+  private:
+    const char *_name;
+    flxDataType_t _type;
+    uint8_t _valueType;
+    double _value;
+    bool _enabled;
+};
+
+class testArray : public flxParameterOut, public flxParameterOutArray
+{
+  public:
+    testArray(const char *name, uint8_t valueType, std::vector<float> values) : _name{name}, _valueType{valueType}
+    {
+        _data.set(values.data(), values.size());
+    }
+    const char *name(void)
+    {
+        return _name;
+    }
+    bool enabled(void)
+    {
+        return true;
+    }
+    uint8_t valueType(void)
+    {
+        return _valueType;
+    }
+    uint32_t flags(void)
+    {
+        return kParameterOutFlagArray;
+    }
+    flxDataType_t type(void)
+    {
+        return flxTypeFloat;
+    }
+    void *accessor(void)
+    {
+        return static_cast<flxParameterOutArray *>(this);
+    }
+    flxDataArray *get(void)
+    {
+        return &_data;
+    }
+
+  private:
+    const char *_name;
+    uint8_t _valueType;
+    flxDataArrayFloat _data;
+};
+
+class testDevice : public flxDevice
+{
+  public:
+    testDevice()
+        : temperature{"Temperature", flxTypeFloat, kParamValueTemperature, 21.5},
+          humidity{"Humidity", flxTypeUInt8, kParamValueHumidity, 45},
+          pressure{"Pressure", flxTypeUInt32, kParamValuePressure, 101325},
+          count{"Count", flxTypeInt16, kParamValueCount, -2}, state{"State", flxTypeBool, kParamValueState, 1},
+          disabled{"Disabled", flxTypeUInt8, kParamValueBattery, 99},
+          location{"Location", kParamValueLocation, {40.0f, -105.0f}},
+          unsupported{"Unsupported", kParamValueBattery, {1.0f, 2.0f, 3.0f}}, nExecute{0}
+    {
+        setName("Test Sensor");
+        disabled.setEnabled(false);
+
+        addOutputParameter(&temperature);
+        addOutputParameter(&humidity);
+        addOutputParameter(&pressure);
+        addOutputParameter(&count);
+        addOutputParameter(&state);
+        addOutputParameter(&disabled);
+        addOutputParameter(&location);
+        addOutputParameter(&unsupported);
+    }
+
+    bool execute(void)
+    {
+        nExecute++;
+        return true;
+    }
+
+    testScalar temperature;
+    testScalar humidity;
+    testScalar pressure;
+    testScalar count;
+    testScalar state;
+    testScalar disabled;
+    testArray location;
+    testArray unsupported;
+
+    uint32_t nExecute;
+};
+
+//----------------------------------------------------------------------------------
+// Expected packet contents - values are tagged with their value type, in network byte order
+
+static void packU8(std::vector<uint8_t> &packet, uint8_t tag, uint8_t value)
+{
+    packet.push_back(tag);
+    packet.push_back(value);
+}
+
+static void packU16(std::vector<uint8_t> &packet, uint8_t tag, uint16_t value)
+{
+    packet.push_back(tag);
+    packet.push_back(value >> 8);
+    packet.push_back(value & 0xFF);
+}
+
+static void packU32(std::vector<uint8_t> &packet, uint8_t tag, uint32_t value)
+{
+    packet.push_back(tag);
+    for (int shift = 24; shift >= 0; shift -= 8)
+        packet.push_back((value >> shift) & 0xFF);
+}
+
+static uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static void padPacket(std::vector<uint8_t> &packet)
+{
+    packet.resize(11, 0);
+}
+
+// The packets an observation of the test device is sent in
+static std::vector<std::vector<uint8_t>> expectedPackets(void)
+{
+    std::vector<std::vector<uint8_t>> packets(3);
+
+    packU32(packets[0], kParamValueTemperature, floatBits(21.5f));
+    packU8(packets[0], kParamValueHumidity, 45);
+    padPacket(packets[0]);
+
+    packU32(packets[1], kParamValuePressure, 101325);
+    packU16(packets[1], kParamValueCount, (uint16_t)-2);
+    packU8(packets[1], kParamValueState, 1);
+    padPacket(packets[1]);
+
+    // location - sent in a packet of its own
+    packets[2].push_back(kParamValueLocation);
+    for (float value : {40.0f, -105.0f})
+    {
+        std::vector<uint8_t> bits;
+        packU32(bits, 0, floatBits(value));
+        packets[2].insert(packets[2].end(), bits.begin() + 1, bits.end());
+    }
+    padPacket(packets[2]);
+
+    return packets;
+}
+
+//----------------------------------------------------------------------------------
+// Test fixture - a connected LoRaWAN object and logger, with the uplinks captured from the simulated modem
+
+typedef struct
+{
+    uint8_t port;
+    uint8_t status;
+    uint8_t frameId;
+    std::vector<uint8_t> payload;
+} capturedUplink_t;
+
+static void onUplink(void *context, flxLoRaWANPacket_t *packet)
+{
+    std::vector<capturedUplink_t> *pUplinks = (std::vector<capturedUplink_t> *)context;
+
+    pUplinks->push_back({packet->port, packet->status, packet->frameId,
+                         std::vector<uint8_t>(packet->payload, packet->payload + packet->payloadSize)});
+}
+
+class testFixture
+{
+  public:
+    testFixture() : sim{nullptr}
+    {
+        flxHostReset();
+        flxHostClearLogCounts();
+        flxHostSetTime(1000);
+
+        logger.add(device);
+        logger.setLoRaWAN(loraWAN);
+
+        loraWAN.initialize();
+
+        // the join runs as a job
+        flxHostRunJobs(2000);
+
+        sim = (flxLoRaWANTransportSim *)loraWAN.transport();
+        if (sim != nullptr)
+        {
+            sim->setClock(millis);
+            sim->setSeed(1);
+            sim->setMonitor(onUplink, &uplinks);
+        }
+    }
+
+    // Run the jobs until the sends are done and reported
+    void drain(void)
+    {
+        for (int i = 0; i < 20 && sim->nPending() > 0; i++)
+            flxHostRunJobs(4000);
+        flxHostRunJobs(4000);
+    }
+
+    testDevice device;
+    flxLoRaWANDigi loraWAN;
+    flxLoRaWANLogger logger;
+    flxLoRaWANTransportSim *sim;
+    std::vector<capturedUplink_t> uplinks;
+};
+
+//----------------------------------------------------------------------------------
+// Tests
+
+static void testConnect(void)
+{
+    testFixture fixture;
+
+    FLX_CHECK(fixture.sim != nullptr);
+    FLX_CHECK(fixture.loraWAN.isConnected());
+    FLX_CHECK_EQ(fixture.loraWAN.joinState(), flxLoRaWANDigi::kJoinStateConnected);
+    FLX_CHECK_EQ(fixture.loraWAN.joinCount(), 1);
+    FLX_CHECK_EQ(flxHostLogCount('E'), 0);
+}
+
+// One observation - the values packed into full packets, in parameter order, on the data port
+static void testObservationPackets(void)
+{
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    fixture.logger.logObservation();
+    fixture.drain();
+
+    std::vector<std::vector<uint8_t>> expected = expectedPackets();
+
+    FLX_CHECK_EQ(fixture.device.nExecute, 1);
+    FLX_CHECK_EQ(fixture.uplinks.size(), expected.size());
+    for (size_t i = 0; i < fixture.uplinks.size() && i < expected.size(); i++)
+    {
+        FLX_CHECK_EQ(fixture.uplinks[i].port, kLoRaWANDataPort);
+        FLX_CHECK_EQ(fixture.uplinks[i].status, kLoRaWANTxStatusSuccess);
+        FLX_CHECK(fixture.uplinks[i].payload == expected[i]);
+    }
+    FLX_CHECK_EQ(fixture.loraWAN.linkStats().nTx(), expected.size());
+    FLX_CHECK_EQ(fixture.loraWAN.linkStats().nTxFailed(), 0);
+    FLX_CHECK(fixture.loraWAN.isConnected());
+}
+
+// Back to back observations - every packet goes out, in order. A send issued while another is on the
+// air must not be dropped.
+static void testObservationBurst(void)
+{
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    const int nObservations = 5;
+    for (int i = 0; i < nObservations; i++)
+        fixture.logger.logObservation();
+
+    fixture.drain();
+
+    FLX_CHECK_EQ(fixture.sim->nPending(), 0);
+    FLX_CHECK_EQ(fixture.uplinks.size(), nObservations * expectedPackets().size());
+    for (size_t i = 1; i < fixture.uplinks.size(); i++)
+        FLX_CHECK_EQ((uint8_t)(fixture.uplinks[i].frameId - fixture.uplinks[i - 1].frameId), 1);
+    FLX_CHECK_EQ(flxHostLogCount('W'), 0);
+}
+
+// Unacknowledged uplinks are counted as failures - they don't end the connection
+static void testLostUplinks(void)
+{
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    fixture.sim->setLossRate(100);
+    fixture.logger.logObservation();
+    fixture.drain();
+
+    FLX_CHECK_EQ(fixture.uplinks.size(), 3);
+    for (auto &uplink : fixture.uplinks)
+        FLX_CHECK_EQ(uplink.status, kLoRaWANTxStatusAckFailed);
+    FLX_CHECK_EQ(fixture.loraWAN.linkStats().nTxFailed(), 3);
+    FLX_CHECK(fixture.loraWAN.isConnected());
+}
+
+// The network forgets the device - the send status ends the connection, and reconnect mode joins again
+static void testSessionLost(void)
+{
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    fixture.sim->dropSession();
+    fixture.logger.logObservation();
+    fixture.drain();
+
+    FLX_CHECK(!fixture.loraWAN.isConnected());
+
+    // reconnect mode - the first attempt is 30 seconds out
+    flxHostRunJobs(60000);
+
+    FLX_CHECK(fixture.loraWAN.isConnected());
+    FLX_CHECK_EQ(fixture.sim->nJoins(), 2);
+
+    // and data flows again
+    fixture.uplinks.clear();
+    fixture.logger.logObservation();
+    fixture.drain();
+    FLX_CHECK_EQ(fixture.uplinks.size(), 3);
+}
+
+// A read request downlink - the values are read and sent on the read port
+static void testReadRequest(void)
+{
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    const uint8_t request[] = {flxLoRaWANLogger::kReadOpDevice, flxLoRaWANLogger::kReadAllDevices};
+    fixture.sim->queueDownlink(kLoRaWANReadPort, request, sizeof(request));
+
+    // the downlink is delivered after an uplink
+    fixture.logger.logObservation();
+    fixture.drain();
+
+    std::vector<std::vector<uint8_t>> expected = expectedPackets();
+    std::vector<capturedUplink_t> replies;
+    for (auto &uplink : fixture.uplinks)
+    {
+        if (uplink.port == kLoRaWANReadPort)
+            replies.push_back(uplink);
+    }
+    FLX_CHECK_EQ(replies.size(), expected.size());
+    for (size_t i = 0; i < replies.size() && i < expected.size(); i++)
+        FLX_CHECK(replies[i].payload == expected[i]);
+
+    // back on the data port
+    FLX_CHECK_EQ(fixture.loraWAN.dataPort(), kLoRaWANDataPort);
+}
+
+// A read request that matches nothing - a single "no values" reply
+static void testReadRequestNoMatch(void)
+{
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    const uint8_t request[] = {flxLoRaWANLogger::kReadOpDeviceName, 'N', 'o', 'n', 'e'};
+    fixture.sim->queueDownlink(kLoRaWANReadPort, request, sizeof(request));
+
+    fixture.logger.logObservation();
+    fixture.drain();
+
+    std::vector<capturedUplink_t> replies;
+    for (auto &uplink : fixture.uplinks)
+    {
+        if (uplink.port == kLoRaWANReadPort)
+            replies.push_back(uplink);
+    }
+    FLX_CHECK_EQ(replies.size(), 1);
+    if (replies.size() == 1)
+        FLX_CHECK(replies[0].payload == std::vector<uint8_t>{kParamValueNone});
+}
+
+// A read request on a gated port - the reply waits until the gate runs the handler (Qwiic power on)
+static void testReadRequestGated(void)
+{
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    std::vector<std::function<void(void)>> gated;
+    fixture.loraWAN.downlink().setPortGate(
+        kLoRaWANReadPort, [&gated](std::function<void(void)> handlerCall) { gated.push_back(handlerCall); });
+
+    const uint8_t request[] = {flxLoRaWANLogger::kReadOpDevice, flxLoRaWANLogger::kReadAllDevices};
+    fixture.sim->queueDownlink(kLoRaWANReadPort, request, sizeof(request));
+
+    fixture.logger.logObservation();
+    fixture.drain();
+
+    auto nReplies = [&fixture]() {
+        size_t n = 0;
+        for (auto &uplink : fixture.uplinks)
+            n += uplink.port == kLoRaWANReadPort ? 1 : 0;
+        return n;
+    };
+    FLX_CHECK_EQ(gated.size(), 1);
+    FLX_CHECK_EQ(nReplies(), 0);
+
+    // the gate opens - the handler runs on its copy of the request
+    for (auto &handlerCall : gated)
+        handlerCall();
+    fixture.drain();
+
+    FLX_CHECK_EQ(nReplies(), expectedPackets().size());
+}
+
+// Link health uplinks - sent on the health port, at the health interval
+static void testHealthUplink(void)
+{
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    const uint8_t healthPort = 3;
+
+    fixture.logger.logObservation();
+    fixture.loraWAN.healthInterval = 1;
+    flxHostRunJobs(62000);
+    fixture.drain();
+
+    size_t nHealth = 0;
+    for (auto &uplink : fixture.uplinks)
+    {
+        if (uplink.port == healthPort)
+        {
+            nHealth++;
+            FLX_CHECK_EQ(uplink.payload.size(), flxLoRaWANLinkStats::kHealthPayloadSize);
+        }
+    }
+    FLX_CHECK_EQ(nHealth, 1);
+
+    // counted in the link statistics like any other uplink
+    FLX_CHECK_EQ(fixture.loraWAN.linkStats().nTx(), expectedPackets().size() + 1);
+}
+
+//----------------------------------------------------------------------------------
+// Benchmark - time to read, pack and queue the sends of an observation
+
+static void benchmarkObservation(void)
+{
+    const int nObservations = 20000;
+
+    testFixture fixture;
+    if (!fixture.sim)
+        return;
+
+    // no airtime - the queue is emptied by each process() call
+    fixture.sim->setAirtime(0, 0);
+    fixture.sim->setMonitor(nullptr);
+
+    std::chrono::nanoseconds logTime{0};
+    for (int i = 0; i < nObservations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        fixture.logger.logObservation();
+        logTime += std::chrono::steady_clock::now() - start;
+
+        // report the sends - process() runs from the process job
+        flxHostRunJobs(4000);
+    }
+
+    uint32_t nSent = fixture.sim->nSent();
+    double usPerObservation = logTime.count() / 1000.0 / nObservations;
+
+    printf("  observations: %d  packets: %u\n", nObservations, nSent);
+    printf("  logObservation(): %.2f us per observation, %.2f us per packet\n", usPerObservation,
+           usPerObservation * nObservations / (nSent > 0 ? nSent : 1));
+
+    FLX_CHECK_EQ(nSent, nObservations * expectedPackets().size());
+}
+
+//----------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    flxHostSetLogOutput(flxTestHasArg(argc, argv, "--log"));
+
+    if (flxTestHasArg(argc, argv, "--bench"))
+    {
+        FLX_RUN_TEST(benchmarkObservation);
+        return flxTestFailures == 0 ? 0 : 1;
+    }
+
+    FLX_RUN_TEST(testConnect);
+    FLX_RUN_TEST(testObservationPackets);
+    FLX_RUN_TEST(testObservationBurst);
+    FLX_RUN_TEST(testLostUplinks);
+    FLX_RUN_TEST(testSessionLost);
+    FLX_RUN_TEST(testReadRequest);
+    FLX_RUN_TEST(testReadRequestNoMatch);
+    FLX_RUN_TEST(testReadRequestGated);
+    FLX_RUN_TEST(testHealthUplink);
+
+    printf("%s\n", flxTestFailures == 0 ? "All tests passed" : "Tests FAILED");
+    return flxTestFailures == 0 ? 0 : 1;
+}
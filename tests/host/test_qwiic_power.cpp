@@ -0,0 +1,280 @@
+/*
+ *---------------------------------------------------------------------------------
+ *
+ * Copyright (c) 2024-2025, SparkFun Electronics Inc.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ *---------------------------------------------------------------------------------
+ */
+
+// Host tests for Qwiic power gating - sfeNLQwiicPower powering the rail for device use, and setting the
+// devices up again after each power on.
+
+#include "flxHostShim.h"
+#include "flxHostTest.h"
+
+#include "sfeNLBoard.h"
+#include "sfeNLQwiicPower.h"
+
+#include <cstring>
+
+int flxTestFailures = 0;
+
+//----------------------------------------------------------------------------------
+// Test device - a mode held in the device registers, which a power off resets, and a measurement the
+// driver starts when initialized.
+
+class gatedDevice : public flxDevice
+{
+  public:
+    gatedDevice() : nInitialize{0}, nModeSets{0}, _mode{0}, _measuring{false}
+    {
+        setName("Gated Device");
+
+        flxRegister(mode, "Mode", "Held by the device - lost at power off");
+        flxRegister(rate, "Rate", "Held by the driver");
+    }
+
+    bool initialize(void) override
+    {
+        nInitialize++;
+        _mode = 0;
+        _measuring = true;
+        return true;
+    }
+
+    // the rail was turned off
+    void powerLost(void)
+    {
+        _mode = 0;
+        _measuring = false;
+    }
+    bool measuring(void)
+    {
+        return _measuring;
+    }
+
+    uint8_t get_mode(void)
+    {
+        return _mode;
+    }
+    void set_mode(uint8_t value)
+    {
+        _mode = value;
+        nModeSets++;
+    }
+
+    flxPropertyRWUInt8<gatedDevice, &gatedDevice::get_mode, &gatedDevice::set_mode> mode;
+    flxPropertyUInt32<gatedDevice> rate = {5};
+
+    uint32_t nInitialize;
+    uint32_t nModeSets;
+
+  private:
+    uint8_t _mode;
+    bool _measuring;
+};
+
+static bool railOn(void)
+{
+    return flxHostPinLevel(kNLBoardEn3v3_SW) == HIGH;
+}
+
+static flxProperty *findProperty(flxObject &object, const char *name)
+{
+    for (auto prop : object.getProperties())
+    {
+        if (strcmp(prop->name(), name) == 0)
+            return prop;
+    }
+    return nullptr;
+}
+
+//----------------------------------------------------------------------------------
+// Each use of the devices powers the rail, waits for the warm-up, and initializes the devices again - then
+// the app setup runs, and the lost settings are written back
+static void testInitializeAfterPowerOn(void)
+{
+    flxHostReset();
+
+    sfeNLQwiicPower power;
+    gatedDevice device;
+    power.addDevice(&device);
+
+    uint32_t nPowerOn = 0;
+    power.setPowerOnAction([&]() {
+        nPowerOn++;
+        FLX_CHECK_EQ(device.nInitialize, nPowerOn);
+    });
+
+    device.mode = 3;
+    device.rate = 10;
+    device.nModeSets = 0;
+
+    power.begin(100);
+    FLX_CHECK(!railOn());
+    device.powerLost();
+
+    for (uint32_t cycle = 1; cycle <= 3; cycle++)
+    {
+        bool bRan = false;
+        power.run([&]() {
+            bRan = true;
+            FLX_CHECK(railOn());
+            FLX_CHECK(device.measuring());
+            FLX_CHECK_EQ(device.get_mode(), 3);
+        });
+
+        // powered, waiting on the warm-up
+        FLX_CHECK(railOn());
+        FLX_CHECK(!bRan);
+        flxHostRunJobs(99);
+        FLX_CHECK(!bRan);
+
+        flxHostRunJobs(2);
+        FLX_CHECK(bRan);
+        FLX_CHECK(!railOn());
+        FLX_CHECK_EQ(device.nInitialize, cycle);
+        FLX_CHECK_EQ(nPowerOn, cycle);
+
+        // only the lost value is written back
+        FLX_CHECK_EQ(device.nModeSets, cycle);
+        FLX_CHECK_EQ(device.rate(), 10);
+
+        device.powerLost();
+    }
+}
+
+// Values the initialize leaves as they were aren't written
+static void testUnchangedValues(void)
+{
+    flxHostReset();
+
+    sfeNLQwiicPower power;
+    gatedDevice device;
+    power.addDevice(&device);
+    power.begin(10);
+
+    for (int cycle = 0; cycle < 3; cycle++)
+    {
+        power.run([]() {});
+        flxHostRunJobs(20);
+    }
+    FLX_CHECK_EQ(device.nInitialize, 3);
+    FLX_CHECK_EQ(device.nModeSets, 0);
+}
+
+// Actions during the warm-up wait for it - one power on for all of them
+static void testRunDuringWarmup(void)
+{
+    flxHostReset();
+
+    sfeNLQwiicPower power;
+    gatedDevice device;
+    power.addDevice(&device);
+    power.begin(100);
+
+    int nRan = 0;
+    power.run([&]() { nRan++; });
+    flxHostRunJobs(50);
+    power.run([&]() { nRan++; });
+    FLX_CHECK_EQ(nRan, 0);
+
+    flxHostRunJobs(60);
+    FLX_CHECK_EQ(nRan, 2);
+    FLX_CHECK_EQ(device.nInitialize, 1);
+    FLX_CHECK(!railOn());
+}
+
+// A hold powers the rail now, and keeps it on until released - actions run right away
+static void testHold(void)
+{
+    flxHostReset();
+
+    sfeNLQwiicPower power;
+    gatedDevice device;
+    power.addDevice(&device);
+    power.begin(100);
+
+    uint32_t startMS = millis();
+    power.hold(true);
+    FLX_CHECK(railOn());
+    FLX_CHECK_EQ(millis() - startMS, 100);
+    FLX_CHECK_EQ(device.nInitialize, 1);
+
+    bool bRan = false;
+    power.run([&]() { bRan = true; });
+    FLX_CHECK(bRan);
+
+    // nested
+    power.hold(true);
+    power.hold(false);
+    FLX_CHECK(railOn());
+
+    power.hold(false);
+    FLX_CHECK(!railOn());
+    FLX_CHECK_EQ(device.nInitialize, 1);
+}
+
+// The warm-up is the longest of the default and the device warm-up times
+static void testDeviceWarmupTime(void)
+{
+    flxHostReset();
+
+    sfeNLQwiicPower power;
+    gatedDevice device;
+    power.addDevice(&device);
+    power.begin(100);
+    FLX_CHECK_EQ(power.warmupTime(), 100);
+
+    flxProperty *warmupTime = findProperty(device, "Warm-up Time");
+    FLX_CHECK(warmupTime != nullptr);
+    if (!warmupTime)
+        return;
+
+    flxDataVariable value;
+    value.type = flxTypeUInt32;
+    value.value.ui32 = 500;
+    FLX_CHECK(warmupTime->setValue(value));
+    FLX_CHECK_EQ(power.warmupTime(), 500);
+
+    bool bRan = false;
+    power.run([&]() { bRan = true; });
+    flxHostRunJobs(490);
+    FLX_CHECK(!bRan);
+    flxHostRunJobs(20);
+    FLX_CHECK(bRan);
+}
+
+// Not enabled - actions run right away, the rail isn't touched
+static void testNotEnabled(void)
+{
+    flxHostReset();
+
+    sfeNLQwiicPower power;
+    gatedDevice device;
+    power.addDevice(&device);
+
+    bool bRan = false;
+    power.run([&]() { bRan = true; });
+    FLX_CHECK(bRan);
+    FLX_CHECK_EQ(device.nInitialize, 0);
+    FLX_CHECK_EQ(flxHostJobsQueued(), 0);
+}
+
+//----------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    flxHostSetLogOutput(flxTestHasArg(argc, argv, "--log"));
+
+    FLX_RUN_TEST(testInitializeAfterPowerOn);
+    FLX_RUN_TEST(testUnchangedValues);
+    FLX_RUN_TEST(testRunDuringWarmup);
+    FLX_RUN_TEST(testHold);
+    FLX_RUN_TEST(testDeviceWarmupTime);
+    FLX_RUN_TEST(testNotEnabled);
+
+    printf("%s\n", flxTestFailures == 0 ? "All tests passed" : "Tests FAILED");
+    return flxTestFailures == 0 ? 0 : 1;
+}